@@ -7,23 +7,68 @@ LD_SRCS += \
 ../src/lscript.ld 
 
 C_SRCS += \
+../src/amp.c \
+../src/arena.c \
 ../src/find_motion.c \
-../src/image.c 
+../src/fslock.c \
+../src/gic.c \
+../src/image.c \
+../src/mailbox.c \
+../src/median.c \
+../src/motion.c \
+../src/ocm.c \
+../src/pipeline.c \
+../src/pool.c \
+../src/prefetch.c \
+../src/prefilter.c \
+../src/region.c \
+../src/task.c \
+../src/telemetry.c 
 
 OBJS += \
+./src/amp.o \
+./src/arena.o \
 ./src/find_motion.o \
-./src/image.o 
+./src/fslock.o \
+./src/gic.o \
+./src/image.o \
+./src/mailbox.o \
+./src/median.o \
+./src/motion.o \
+./src/ocm.o \
+./src/pipeline.o \
+./src/pool.o \
+./src/prefetch.o \
+./src/prefilter.o \
+./src/region.o \
+./src/task.o \
+./src/telemetry.o 
 
 C_DEPS += \
+./src/amp.d \
+./src/arena.d \
 ./src/find_motion.d \
-./src/image.d 
+./src/fslock.d \
+./src/gic.d \
+./src/image.d \
+./src/mailbox.d \
+./src/median.d \
+./src/motion.d \
+./src/ocm.d \
+./src/pipeline.d \
+./src/pool.d \
+./src/prefetch.d \
+./src/prefilter.d \
+./src/region.d \
+./src/task.d \
+./src/telemetry.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
 src/%.o: ../src/%.c
 	@echo 'Building file: $<'
 	@echo 'Invoking: ARM v7 gcc compiler'
-	arm-none-eabi-gcc -Wall -O0 -g3 -pg -c -fmessage-length=0 -MT"$@" -mcpu=cortex-a9 -mfpu=vfpv3 -mfloat-abi=hard -I../../find_motion_bsp/ps7_cortexa9_0/include -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
+	arm-none-eabi-gcc -Wall -O0 -g3 -pg -c -fmessage-length=0 -MT"$@" -mcpu=cortex-a9 -mfpu=neon -mfloat-abi=hard -I../../find_motion_bsp/ps7_cortexa9_0/include -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
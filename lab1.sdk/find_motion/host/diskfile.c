@@ -0,0 +1,246 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : diskfile.c                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The FatFs disk interface over an image file of diskfile.h.             */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "diskfile.h"
+#include "ff.h"
+#include "diskio.h"
+
+DiskStats disk_stats;
+
+static int    disk_fd = -1;
+static uint32 disk_sectors;
+static long   disk_latency;   /* microseconds per command              */
+static float  disk_rate;      /* bytes per microsecond, 0 if unlimited */
+
+int diskfile_create(const char *path, uint32 sectors)
+/* Create an empty image of sectors sectors, or truncate an existing  */
+/* one. The file is sparse until it is written. Returns 1 on failure. */
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+    {
+        return 1;
+    }
+    if (ftruncate(fd, (off_t) sectors*DISK_SECTOR))
+    {
+        close(fd);
+        return 1;
+    }
+    close(fd);
+    return 0;
+}
+
+int diskfile_open(const char *path, long latency, float mb_per_sec)
+/* Make the image the drive 0 of FatFs. Every command then takes        */
+/* latency microseconds plus its sectors at mb_per_sec MB/s; 0 means no */
+/* delay. Returns 1 if the image cannot be opened.                      */
+{
+    struct stat st;
+
+    diskfile_close();
+    disk_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (disk_fd < 0 || fstat(disk_fd, &st))
+    {
+        diskfile_close();
+        return 1;
+    }
+    disk_sectors = (uint32) (st.st_size/DISK_SECTOR);
+    disk_latency = (latency > 0)? latency : 0;
+    disk_rate = (mb_per_sec > 0)? mb_per_sec : 0;
+    clear_diskfile();
+    return 0;
+}
+
+void diskfile_close(void)
+{
+    if (disk_fd >= 0)
+    {
+        close(disk_fd);
+    }
+    disk_fd = -1;
+    disk_sectors = 0;
+}
+
+static void count_size(long *sizes, UINT sectors)
+/* Count a command of sectors sectors in sizes[]. */
+{
+    int k;
+
+    for (k = 0; k < DISK_SIZES-1 && (sectors >> (k+1)) != 0; k++)
+        ;
+    sizes[k]++;
+}
+
+static long clock_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static void card_delay(UINT sectors)
+/* Spend the time the card would take for a command of sectors sectors, */
+/* spinning like the polled transfers of the SD driver.                */
+{
+    long usec, end;
+
+    if (disk_latency == 0 && disk_rate == 0)
+    {
+        return;
+    }
+    usec = disk_latency;
+    if (disk_rate > 0)
+    {
+        usec += (long) (sectors*DISK_SECTOR/disk_rate);
+    }
+    disk_stats.usec += usec;
+    for (end = clock_usec() + usec; clock_usec() < end; )
+        ;
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+    return (pdrv != 0 || disk_fd < 0)? STA_NOINIT | STA_NODISK : 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    size_t bytes = (size_t) count*DISK_SECTOR;
+
+    if (disk_status(pdrv))
+    {
+        return RES_NOTRDY;
+    }
+    if (sector >= disk_sectors || count > disk_sectors - sector)
+    {
+        return RES_PARERR;
+    }
+    card_delay(count);
+    if (pread(disk_fd, buff, bytes, (off_t) sector*DISK_SECTOR)
+        != (ssize_t) bytes)
+    {
+        return RES_ERROR;
+    }
+    disk_stats.reads++;
+    disk_stats.read_sectors += count;
+    count_size(disk_stats.read_sizes, count);
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    size_t bytes = (size_t) count*DISK_SECTOR;
+
+    if (disk_status(pdrv))
+    {
+        return RES_NOTRDY;
+    }
+    if (sector >= disk_sectors || count > disk_sectors - sector)
+    {
+        return RES_PARERR;
+    }
+    card_delay(count);
+    if (pwrite(disk_fd, buff, bytes, (off_t) sector*DISK_SECTOR)
+        != (ssize_t) bytes)
+    {
+        return RES_ERROR;
+    }
+    disk_stats.writes++;
+    disk_stats.write_sectors += count;
+    count_size(disk_stats.write_sizes, count);
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    if (disk_status(pdrv))
+    {
+        return RES_NOTRDY;
+    }
+    switch (cmd)
+    {
+    case CTRL_SYNC:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(DWORD *) buff = disk_sectors;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *) buff = DISK_SECTOR;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *) buff = 1;      /* erase block unknown */
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void)
+/* The local time in the FAT format, for the time stamps of the files. */
+{
+    time_t    now = time(NULL);
+    struct tm tm;
+
+    localtime_r(&now, &tm);
+    return ((DWORD) (tm.tm_year - 80) << 25) | ((DWORD) (tm.tm_mon + 1) << 21)
+           | ((DWORD) tm.tm_mday << 16) | ((DWORD) tm.tm_hour << 11)
+           | ((DWORD) tm.tm_min << 5) | ((DWORD) tm.tm_sec >> 1);
+}
+
+void report_diskfile(void)
+/* Print the commands sent to the image since the last clear. */
+{
+    char range[24];
+    int  k;
+
+    printf("\nDisk   commands   sectors  avg sectors\n");
+    printf("read   %8ld  %8ld  %11.1f\n", disk_stats.reads,
+           disk_stats.read_sectors,
+           (float) disk_stats.read_sectors/(disk_stats.reads? disk_stats.reads : 1));
+    printf("write  %8ld  %8ld  %11.1f\n", disk_stats.writes,
+           disk_stats.write_sectors,
+           (float) disk_stats.write_sectors/(disk_stats.writes? disk_stats.writes : 1));
+    if (disk_stats.usec)
+    {
+        printf("Simulated card time: %.1f ms.\n", disk_stats.usec/1000.0);
+    }
+    printf("\nSectors      reads    writes\n");
+    for (k = 0; k < DISK_SIZES; k++)
+    {
+        if (!disk_stats.read_sizes[k] && !disk_stats.write_sizes[k])
+        {
+            continue;
+        }
+        if (k == DISK_SIZES-1)
+        {
+            sprintf(range, "%d+", 1 << k);
+        }
+        else
+        {
+            sprintf(range, (k == 0)? "%d" : "%d-%d", 1 << k, (2 << k) - 1);
+        }
+        printf("%-9s  %8ld  %8ld\n", range, disk_stats.read_sizes[k],
+               disk_stats.write_sizes[k]);
+    }
+}
+
+void clear_diskfile(void)
+{
+    memset(&disk_stats, 0, sizeof(disk_stats));
+}
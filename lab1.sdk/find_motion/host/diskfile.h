@@ -0,0 +1,50 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : diskfile.h                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Disk interface of FatFs (diskio.h) for the host build: drive 0 is a    */
+/*  FAT image in a regular file instead of the SD card, so that the file   */
+/*  I/O of the engine runs on a workstation all the way down to the        */
+/*  sectors, with the FatFs and the configuration of the BSP. It replaces  */
+/*  diskio.c of xilffs, which only drives the SD controller.               */
+/*                                                                         */
+/*  The image can be made to behave like a card: every disk_read() and     */
+/*  disk_write() then takes latency microseconds plus its sectors at the   */
+/*  given bandwidth, spun by the caller as the polled transfers of the     */
+/*  SD driver spin on the target. The commands are counted by size,        */
+/*  which shows how FatFs splits a transfer into sectors and clusters.     */
+/*                                                                         */
+/*  mkfatimg.c builds an image from a directory of PGM files and           */
+/*  fatbench.c times the reads of the engine on it.                        */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __DISKFILE_H__
+
+#include "image.h"
+
+/* Size of a sector, as on the SD card. */
+#define DISK_SECTOR 512
+
+/* The read and write commands are counted by size in powers of two:   */
+/* 1 sector, 2-3, 4-7, ... and 2^(DISK_SIZES-1) = 2048 sectors or more. */
+#define DISK_SIZES 12
+
+typedef struct
+{
+    long reads, writes;               /* commands                        */
+    long read_sectors, write_sectors;
+    long read_sizes[DISK_SIZES];      /* read commands by size           */
+    long write_sizes[DISK_SIZES];
+    long usec;                        /* simulated card time             */
+} DiskStats;
+
+extern DiskStats disk_stats;
+
+int  diskfile_create(const char *path, uint32 sectors);
+int  diskfile_open(const char *path, long latency, float mb_per_sec);
+void diskfile_close(void);
+void report_diskfile(void);
+void clear_diskfile(void);
+
+#define __DISKFILE_H__
+#endif
@@ -0,0 +1,145 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : fatbench.c                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Times the file I/O of the engine on a FAT image (see diskfile.h):      */
+/*  every PGM and PPM file in the root of the image is read with           */
+/*  read_pnm_image() passes times, then the last one is written back with  */
+/*  write_pnm_image(). The image can be given the latency and bandwidth    */
+/*  of an SD card. The throughputs are printed with the disk commands      */
+/*  FatFs issued, by size. An MB is 10^6 bytes, in the sizes as in the     */
+/*  rates and in the bandwidth of the card.                                */
+/*                                                                         */
+/*  Usage: fatbench image [latency_usec [MB/s [passes]]]                   */
+/*                                                                         */
+/*  Build it like motiond.c.                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <strings.h>
+#include <time.h>
+#include "diskfile.h"
+#include "arena.h"
+#include "ff.h"
+
+/* Largest number of files read. */
+#define MAX_FILES 1024
+
+/* Name of the file written back, removed at the end. */
+#define OUT_NAME "FATBENCH.PGM"
+
+long get_usec_time()
+/* Microsecond clock of the volume locks and of the timings. */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static int list_files(char names[][13], long *sizes)
+/* The PGM and PPM files in the root of the volume. */
+{
+    DIR     dir;
+    FILINFO info;
+    char    *dot;
+    int     n = 0;
+
+    if (f_opendir(&dir, "/"))
+    {
+        return 0;
+    }
+    while (n < MAX_FILES && !f_readdir(&dir, &info) && info.fname[0])
+    {
+        dot = strrchr(info.fname, '.');
+        if (!(info.fattrib & AM_DIR) && dot
+            && (!strcasecmp(dot, ".pgm") || !strcasecmp(dot, ".ppm")))
+        {
+            strcpy(names[n], info.fname);
+            sizes[n++] = (long) info.fsize;
+        }
+    }
+    f_closedir(&dir);
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    static FATFS fatfs;
+    static char  names[MAX_FILES][13];
+    static long  sizes[MAX_FILES];
+    CImage       image;
+    long         latency, bytes = 0, t;
+    float        rate;
+    int          passes, n, i, pass, errors = 0;
+
+    if (argc < 2)
+    {
+        printf("Usage: fatbench image [latency_usec [MB/s [passes]]]\n");
+        return 1;
+    }
+    latency = (argc > 2)? atol(argv[2]) : 0;
+    rate = (argc > 3)? (float) atof(argv[3]) : 0;
+    passes = (argc > 4)? atoi(argv[4]) : 1;
+    passes = (passes < 1)? 1 : passes;
+    if (diskfile_open(argv[1], latency, rate) || f_mount(&fatfs, "0:/", 1))
+    {
+        printf("fatbench: cannot mount the image '%s'.\n", argv[1]);
+        return 1;
+    }
+    if ((n = list_files(names, sizes)) == 0)
+    {
+        printf("fatbench: no PGM or PPM file in '%s'.\n", argv[1]);
+        return 1;
+    }
+    printf("%s: %d files, cluster %lu KB, card latency %ld us, %s MB/s.\n",
+           argv[1], n, (unsigned long) fatfs.csize*DISK_SECTOR/1024, latency,
+           (rate > 0)? argv[3] : "unlimited");
+
+    /* Read every file passes times. */
+    clear_diskfile();
+    t = get_usec_time();
+    for (pass = 0; pass < passes; pass++)
+    {
+        for (i = 0; i < n; i++)
+        {
+            if (read_pnm_image(names[i], &image))
+            {
+                errors++;
+            }
+            else
+            {
+                bytes += sizes[i];
+            }
+            arena_reset(&frame_arena);
+        }
+    }
+    t = get_usec_time() - t;
+    printf("\nRead  %ld files, %.1f MB in %.1f ms: %.2f MB/s.\n",
+           (long) n*passes, bytes/1e6, t/1000.0,
+           (float) bytes/(t > 0? t : 1));
+    report_diskfile();
+
+    /* Write the last file back. */
+    if (read_pnm_image(names[n-1], &image) == 0)
+    {
+        clear_diskfile();
+        t = get_usec_time();
+        errors += write_pnm_image(OUT_NAME, &image);
+        t = get_usec_time() - t;
+        printf("\nWrite %s, %.1f MB in %.1f ms: %.2f MB/s.\n", OUT_NAME,
+               sizes[n-1]/1e6, t/1000.0,
+               (float) sizes[n-1]/(t > 0? t : 1));
+        report_diskfile();
+        f_unlink(OUT_NAME);
+        arena_reset(&frame_arena);
+    }
+
+    if (errors)
+    {
+        printf("\n%d files could not be read or written!\n", errors);
+    }
+    f_mount(NULL, "0:/", 0);
+    diskfile_close();
+    return errors != 0;
+}
@@ -0,0 +1,221 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : mailboxcheck.c                                                */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Stress test of the mailboxes (mailbox.h) on the host, where the       */
+/*  indices are C11 atomics. A mailbox of 1 to 64 slots is first filled   */
+/*  and drained by one thread, checking that mailbox_send() fails when it */
+/*  is full and mailbox_receive() when it is empty. Then a producer and a */
+/*  consumer thread pass count messages through it, the producer with     */
+/*  mailbox_send() and mailbox_send_wait() in turn; the consumer checks  */
+/*  that the messages arrive in order and unchanged, and both sides sum  */
+/*  them. The indices start 256 messages before they wrap around.        */
+/*                                                                         */
+/*  Usage: mailboxcheck [count]                                           */
+/*                                                                         */
+/*  Build it like motiond.c.                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <time.h>
+#include "mailbox.h"
+#include "ocm.h"
+
+/* Default number of messages of each run. */
+#define MESSAGES 1000000
+
+/* Indices of a new mailbox, 256 messages before they wrap. */
+#define START_INDEX ((uint32) 0 - 256)
+
+typedef struct
+{
+    Mailbox *box;
+    uint32   count;
+    uint32   sum;        /* checksum of the messages sent or received     */
+    uint32   waits;      /* times the mailbox was full or empty           */
+    uint32   errors;     /* messages out of order or damaged              */
+} Side;
+
+long get_usec_time()
+/* Microsecond clock of the tasks and of the volume locks. */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static void make_message(Message *msg, uint32 seq)
+/* Message seq: its number, a hash of it, and both combined. */
+{
+    msg->type = seq & 0xff;
+    msg->arg[0] = seq;
+    msg->arg[1] = seq*2654435761u;
+    msg->arg[2] = msg->arg[0] ^ msg->arg[1] ^ msg->type;
+}
+
+static uint32 checksum(uint32 sum, const Message *msg)
+{
+    return (sum ^ msg->arg[1])*16777619u + msg->arg[2];
+}
+
+static void reset_mailbox(Mailbox *box)
+{
+    atomic_store(&box->head, START_INDEX);
+    atomic_store(&box->tail, START_INDEX);
+}
+
+static void *producer(void *arg)
+{
+    Side   *side = arg;
+    Message msg;
+    uint32  seq;
+
+    for (seq = 0; seq < side->count; seq++)
+    {
+        make_message(&msg, seq);
+        side->sum = checksum(side->sum, &msg);
+        if (seq & 1)
+        {
+            mailbox_send_wait(side->box, &msg);
+            continue;
+        }
+        while (mailbox_send(side->box, &msg))
+        {
+            side->waits++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    Side   *side = arg;
+    Message msg, want;
+    uint32  seq;
+
+    for (seq = 0; seq < side->count; seq++)
+    {
+        if (seq & 1)
+        {
+            mailbox_receive_wait(side->box, &msg);
+        }
+        else
+        {
+            while (mailbox_receive(side->box, &msg))
+            {
+                side->waits++;
+                sched_yield();
+            }
+        }
+        make_message(&want, seq);
+        if (memcmp(&msg, &want, sizeof(Message)))
+        {
+            if (side->errors++ < 5)
+            {
+                printf("  message %lu: got %lu (%08lx %08lx %08lx)\n", seq,
+                       msg.arg[0], msg.type, msg.arg[1], msg.arg[2]);
+            }
+        }
+        side->sum = checksum(side->sum, &msg);
+    }
+    return NULL;
+}
+
+static int check_full_empty(Mailbox *box)
+/* One thread: fill the mailbox, check that it refuses one more message, */
+/* then drain it and check that it has none left. Returns the errors.    */
+{
+    Message msg;
+    uint32  slots = box->mask + 1, i;
+    int     errors = 0;
+
+    reset_mailbox(box);
+    if (!mailbox_receive(box, &msg))
+    {
+        printf("  empty mailbox gave a message.\n");
+        errors++;
+    }
+    for (i = 0; i < slots; i++)
+    {
+        make_message(&msg, i);
+        if (mailbox_send(box, &msg))
+        {
+            printf("  mailbox full after %lu of %lu messages.\n", i, slots);
+            return errors + 1;
+        }
+    }
+    if (mailbox_count(box) != slots || !mailbox_send(box, &msg))
+    {
+        printf("  full mailbox took a message.\n");
+        errors++;
+    }
+    for (i = 0; i < slots; i++)
+    {
+        if (mailbox_receive(box, &msg) || msg.arg[0] != i)
+        {
+            printf("  message %lu of the full mailbox lost.\n", i);
+            return errors + 1;
+        }
+    }
+    if (mailbox_count(box) != 0 || !mailbox_receive(box, &msg))
+    {
+        printf("  drained mailbox gave a message.\n");
+        errors++;
+    }
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    static const int slots[] = { 1, 2, 4, 64 };
+    Mailbox  *box;
+    Side      prod, cons;
+    pthread_t tp, tc;
+    uint32    count;
+    long      start;
+    int       i, errors = 0;
+
+    count = (argc > 1)? (uint32) atol(argv[1]) : MESSAGES;
+    printf("slots  full  empty  usec/message  result\n");
+    for (i = 0; i < (int) (sizeof(slots)/sizeof(slots[0])); i++)
+    {
+        ocm_init();
+        box = mailbox_create("mailbox", slots[i]);
+        errors += check_full_empty(box);
+
+        reset_mailbox(box);
+        memset(&prod, 0, sizeof(prod));
+        prod.box = box;
+        prod.count = count;
+        cons = prod;
+        start = get_usec_time();
+        pthread_create(&tp, NULL, producer, &prod);
+        pthread_create(&tc, NULL, consumer, &cons);
+        pthread_join(tp, NULL);
+        pthread_join(tc, NULL);
+
+        if (mailbox_count(box) != 0 || atomic_load(&box->head) !=
+            START_INDEX + count)
+        {
+            printf("  %lu messages left, head %08lx.\n", mailbox_count(box),
+                   (uint32) atomic_load(&box->head));
+            cons.errors++;
+        }
+        if (cons.sum != prod.sum)
+        {
+            printf("  checksum %08lx sent, %08lx received.\n", prod.sum,
+                   cons.sum);
+            cons.errors++;
+        }
+        errors += cons.errors;
+        printf("%5d  %4s  %5s  %12.3f  %s\n", slots[i],
+               prod.waits? "yes" : "no", cons.waits? "yes" : "no",
+               (double) (get_usec_time() - start)/(count? count : 1),
+               cons.errors? "FAILED" : "ok");
+    }
+    printf("mailboxes: %lu messages per run, %d errors.\n", count, errors);
+    return errors != 0;
+}
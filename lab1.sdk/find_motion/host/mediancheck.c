@@ -0,0 +1,142 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : mediancheck.c                                                 */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Checks median_filter() (median.h) against a brute-force median that   */
+/*  sorts every (2r+1)x(2r+1) window with qsort(). Random and smooth      */
+/*  images of several sizes, down to one window wide or high, are         */
+/*  filtered in a buffer wider than the image, for every radius from 1   */
+/*  to max_radius; the filtered image, border and padding included, must  */
+/*  match the reference exactly.                                          */
+/*                                                                         */
+/*  Usage: mediancheck [max_radius]                                       */
+/*                                                                         */
+/*  Build it like motiond.c.                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <time.h>
+#include "median.h"
+#include "arena.h"
+
+/* Default largest radius checked. */
+#define MAX_RADIUS 12
+
+/* Columns of padding right of every row. */
+#define PAD 5
+
+long get_usec_time()
+/* Microsecond clock of the tasks and of the volume locks. */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static int compare_pixels(const void *a, const void *b)
+{
+    return *(const uint8 *) a - *(const uint8 *) b;
+}
+
+static void reference_median(uint8 *dst, uint8 *src, int width, int height,
+                             int stride, int radius, uint8 *window)
+/* The median filter of median_filter(), one qsort() per pixel: src is */
+/* copied to dst, then every pixel farther than radius from the border */
+/* is replaced by the median of its window in src.                     */
+{
+    int size = 2*radius+1, x, y, i, j, n;
+
+    memcpy(dst, src, (size_t) height*stride);
+    for (y = radius; y < height-radius; y++)
+    {
+        for (x = radius; x < width-radius; x++)
+        {
+            for (n = 0, j = -radius; j <= radius; j++)
+            {
+                for (i = -radius; i <= radius; i++)
+                {
+                    window[n++] = src[(y+j)*stride + x+i];
+                }
+            }
+            qsort(window, n, 1, compare_pixels);
+            dst[y*stride + x] = window[size*size/2];
+        }
+    }
+}
+
+static void fill_image(uint8 *image, int width, int height, int stride,
+                       int smooth)
+/* Random pixels, or a gradient with a little noise and a few impulses. */
+{
+    int x, y, v;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < stride; x++)
+        {
+            if (!smooth)
+            {
+                v = rand() & 0xff;
+            }
+            else
+            {
+                v = (x*3 + y*2)/2 + (rand() % 7) - 3;
+                v = (rand() % 50 == 0)? (rand() & 1)*255 : v;
+            }
+            image[y*stride + x] = (uint8) ((v < 0)? 0 : (v > 255)? 255 : v);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const int sizes[][2] = { {64, 48}, {97, 61}, {200, 3} };
+    uint8 *image, *orig, *ref, *window;
+    int   max_radius, radius, size, k, smooth, width, height, stride;
+    int   checks = 0, errors = 0;
+    long  n;
+
+    max_radius = (argc > 1)? atoi(argv[1]) : MAX_RADIUS;
+    max_radius = (max_radius < 1)? 1 : max_radius;
+    srand(1);
+    for (radius = 1; radius <= max_radius; radius++)
+    {
+        size = 2*radius+1;
+        for (k = 0; k < 5; k++)
+        {
+            /* The fixed sizes, then one window wide and one window high. */
+            width = (k < 3)? sizes[k][0] : (k == 3)? size : 3*size + 7;
+            height = (k < 3)? sizes[k][1] : (k == 3)? 2*size + 3 : size;
+            if (width < 3 || height < 3)
+            {
+                continue;
+            }
+            stride = width + PAD;
+            n = (long) height*stride;
+            for (smooth = 0; smooth < 2; smooth++)
+            {
+                image = get_memory("image", n);
+                orig = get_memory("original", n);
+                ref = get_memory("reference", n);
+                window = get_memory("window", size*size);
+                fill_image(orig, width, height, stride, smooth);
+                memcpy(image, orig, n);
+                median_filter(image, width, height, stride, radius);
+                reference_median(ref, orig, width, height, stride, radius,
+                                 window);
+                checks++;
+                if (memcmp(image, ref, n))
+                {
+                    printf("radius %d, %dx%d %s image: mismatch.\n", radius,
+                           width, height, smooth? "smooth" : "random");
+                    errors++;
+                }
+                arena_reset(&frame_arena);
+            }
+        }
+    }
+    printf("median_filter(): %d images for radii 1 to %d, %d mismatches.\n",
+           checks, max_radius, errors);
+    return errors != 0;
+}
@@ -0,0 +1,140 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : mkfatimg.c                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Builds a FAT image for diskfile.h out of the PGM and PPM files of a    */
+/*  directory. The image is formatted by f_mkfs() of the BSP FatFs, with   */
+/*  a partition table as on an SD card, and the files are copied in the    */
+/*  order of their names, so a sequence 0001.pgm, 0002.pgm, ... is laid    */
+/*  out one frame after the other as when it is copied onto a fresh card.  */
+/*  The names must be 8.3 names, since the BSP has no long file names.     */
+/*                                                                         */
+/*  Usage: mkfatimg image dir [megabytes [cluster_kb]]                     */
+/*                                                                         */
+/*  The defaults give FAT32 with the 32KB clusters of an SDHC card; the    */
+/*  image is sparse, so only the copied files take space on the disk.      */
+/*  Build it like motiond.c.                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <glob.h>
+#include <time.h>
+#include "diskfile.h"
+#include "ff.h"
+
+/* Default size of the image and of its clusters. */
+#define IMAGE_MB   4096
+#define CLUSTER_KB 32
+
+/* Bytes copied per f_write(). */
+#define COPY_CHUNK (64*1024)
+
+long get_usec_time()
+/* Microsecond clock of the volume locks (fslock.c). */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static long copy_file(const char *path, uint8 *buf)
+/* Copy a file into the root of the image. Returns its size, or -1 on  */
+/* error.                                                               */
+{
+    const char *name = strrchr(path, '/')? strrchr(path, '/') + 1 : path;
+    FILE   *in;
+    FIL    out;
+    UINT   nbytes;
+    size_t n;
+    long   size = 0;
+
+    if ((in = fopen(path, "rb")) == NULL)
+    {
+        return -1;
+    }
+    if (f_open(&out, name, FA_CREATE_ALWAYS | FA_WRITE))
+    {
+        fclose(in);
+        return -1;
+    }
+    while ((n = fread(buf, 1, COPY_CHUNK, in)) > 0)
+    {
+        if (f_write(&out, buf, n, &nbytes) || nbytes != n)
+        {
+            size = -1;
+            break;
+        }
+        size += n;
+    }
+    fclose(in);
+    return (f_close(&out) || size < 0)? -1 : size;
+}
+
+int main(int argc, char **argv)
+{
+    static FATFS fatfs;
+    char         pattern[1024];
+    glob_t       files;
+    uint8        *buf;
+    long         megabytes, cluster_kb, size, total = 0;
+    int          i, copied = 0;
+
+    if (argc < 3)
+    {
+        printf("Usage: mkfatimg image dir [megabytes [cluster_kb]]\n");
+        return 1;
+    }
+    megabytes = (argc > 3)? atol(argv[3]) : IMAGE_MB;
+    cluster_kb = (argc > 4)? atol(argv[4]) : CLUSTER_KB;
+    if (megabytes < 1 || megabytes > 32*1024 || cluster_kb < 1
+        || cluster_kb > 64 || (cluster_kb & (cluster_kb-1)))
+    {
+        printf("mkfatimg: the image is 1 .. 32768 MB and a cluster is 1, 2, 4, ... 64 KB.\n");
+        return 1;
+    }
+    /* The files, sorted by name. */
+    snprintf(pattern, sizeof(pattern), "%s/*.[pP][gGpP][mM]", argv[2]);
+    if (glob(pattern, 0, NULL, &files))
+    {
+        printf("mkfatimg: no PGM or PPM file in '%s'.\n", argv[2]);
+        return 1;
+    }
+
+    if (diskfile_create(argv[1], (uint32) (megabytes*(1024*1024/DISK_SECTOR)))
+        || diskfile_open(argv[1], 0, 0))
+    {
+        printf("mkfatimg: cannot create the image '%s'.\n", argv[1]);
+        return 1;
+    }
+    if (f_mount(&fatfs, "0:/", 0)
+        || f_mkfs("0:/", 0, (UINT) (cluster_kb*1024)))
+    {
+        printf("mkfatimg: cannot format the image.\n");
+        return 1;
+    }
+
+    buf = malloc(COPY_CHUNK);
+    for (i = 0; i < (int) files.gl_pathc; i++)
+    {
+        if ((size = copy_file(files.gl_pathv[i], buf)) < 0)
+        {
+            printf("mkfatimg: cannot copy '%s', skipped.\n", files.gl_pathv[i]);
+        }
+        else
+        {
+            total += size, copied++;
+        }
+    }
+    free(buf);
+
+    printf("%s: FAT%s, %ld MB, %ld KB clusters, %d files, %.1f MB.\n",
+           argv[1], (fatfs.fs_type == FS_FAT32)? "32" :
+           (fatfs.fs_type == FS_FAT16)? "16" : "12", megabytes, cluster_kb,
+           copied, total/(1024.0*1024.0));
+    f_mount(NULL, "0:/", 0);
+    diskfile_close();
+    i = copied < (int) files.gl_pathc;
+    globfree(&files);
+    return i;
+}
@@ -0,0 +1,507 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : motiond.c                                                     */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Motion-estimation daemon of the host build (see motiond.h). A single  */
+/*  thread serves all the clients with poll(). It collects the pairs      */
+/*  submitted since the last batch, filters and searches the ones of the  */
+/*  same size together on the thread pool (median3x3_pool() and           */
+/*  full_search_pool()), and answers every client of the batch. The pairs */
+/*  that arrive during a batch make up the next one, so the batches grow  */
+/*  with the load and an idle daemon answers a lone pair at once. A batch */
+/*  only takes the pairs its frames and buffers have room for in the     */
+/*  arenas; the others wait for the next batch.                           */
+/*                                                                         */
+/*  Usage: motiond [socket [threads]]                                     */
+/*                                                                         */
+/*  Build it with the sources of the engine, all but find_motion.c, the    */
+/*  FatFs of the BSP and diskfile.c, which stands in for its SD driver:    */
+/*                                                                         */
+/*      BSP=../../find_motion_bsp/ps7_cortexa9_0                           */
+/*      cc -O2 -DHOST_BUILD -pthread -I. -I../src -I$BSP/include \         */
+/*         motiond.c diskfile.c $ENGINE                          \         */
+/*         $BSP/libsrc/xilffs_v3_5/src/ff.c -o motiond                     */
+/*                                                                         */
+/*  where $ENGINE lists the .c files of ../src but find_motion.c. Ctrl-C   */
+/*  prints the batch statistics.                                           */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "motiond.h"
+#include "arena.h"
+#include "median.h"
+#include "ocm.h"
+#include "pool.h"
+
+/* Clients served at once. */
+#define MAX_CLIENTS 128
+
+/* Largest number of pairs filtered and searched together. */
+#define MAX_BATCH 32
+
+/* Largest frame side accepted. */
+#define MAX_SIDE 8192
+
+/* A frame is prefiltered if more than NOISE_RATIO percent of the pixels */
+/* examined by estimate_noise() are impulses, as in find_motion.c.       */
+#define NOISE_RATIO 0.5f
+
+typedef struct
+{
+    int       fd;          /* the socket, -1 if the entry is free        */
+    uint8     *buf;        /* the attached buffer                        */
+    size_t    size;
+    int       pending;     /* req is a pair waiting for a batch          */
+    DaemonMsg req;
+} Client;
+
+typedef struct
+{
+    Client **batch;
+    CFrame *frames;        /* the previous and current frame of a pair   */
+    int    *filtered;
+} BatchJob;
+
+static Client clients[MAX_CLIENTS];
+static int    next_client; /* where the next batch starts looking        */
+static long   batches, pairs, busy_usec;
+static volatile sig_atomic_t quit;
+
+long get_usec_time()
+/* Microsecond clock of the engine and of the statistics. */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static void stop(int sig)
+{
+    quit = 1;
+}
+
+static void drop_client(Client *c)
+{
+    if (c->buf != NULL)
+    {
+        munmap(c->buf, c->size);
+    }
+    if (c->fd >= 0)
+    {
+        close(c->fd);
+    }
+    memset(c, 0, sizeof(Client));
+    c->fd = -1;
+}
+
+static void send_msg(Client *c, uint32 type, uint32 id, uint32 size)
+/* Answer a client. A client that cannot take the answer is dropped. */
+{
+    DaemonMsg msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.type = type, msg.id = id, msg.size = size;
+    if (c->fd >= 0 && send(c->fd, &msg, sizeof(msg), MSG_DONTWAIT)
+                      != sizeof(msg))
+    {
+        drop_client(c);
+    }
+}
+
+static int attach(Client *c, int memfd, uint32 size)
+/* Map the buffer of a client. The buffer must be sealed against        */
+/* shrinking, or the client could truncate it under the mapping and     */
+/* the daemon would die of SIGBUS on its next pair. Returns 1 if it is  */
+/* not sealed or is smaller than size.                                  */
+{
+    struct stat st;
+    void *buf;
+    int  seals = fcntl(memfd, F_GET_SEALS);
+
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)
+        || fstat(memfd, &st) || (size_t) st.st_size < size || size == 0)
+    {
+        return 1;
+    }
+    buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (buf == MAP_FAILED)
+    {
+        return 1;
+    }
+    if (c->buf != NULL)
+    {
+        munmap(c->buf, c->size);
+    }
+    c->buf = buf, c->size = size;
+    return 0;
+}
+
+static int valid_request(Client *c, DaemonMsg *msg)
+/* Check that the frames and the vectors of a pair are in the buffer,   */
+/* and that there is room for the two padded frames in the pool arena:  */
+/* a pair too large for it, or of a new size once there are MAX_POOLS   */
+/* sizes, could never be searched.                                      */
+{
+    size_t frame, vectors;
+
+    if (c->buf == NULL || msg->width < 3 || msg->height < 3
+        || msg->width > MAX_SIDE || msg->height > MAX_SIDE
+        || pool_room(frame_bytes(msg->width, msg->height, FRAME_PAD)) < 2)
+    {
+        return 0;
+    }
+    frame = (size_t) msg->width*msg->height;
+    vectors = sizeof(MVector)*(msg->width/MSTEP)*(msg->height/MSTEP);
+    return msg->prev <= c->size && frame <= c->size - msg->prev
+           && msg->curr <= c->size && frame <= c->size - msg->curr
+           && msg->mv <= c->size && vectors <= c->size - msg->mv;
+}
+
+static void receive(Client *c)
+/* Take one message from a client. */
+{
+    DaemonMsg      msg;
+    struct msghdr  hdr;
+    struct iovec   iov;
+    struct cmsghdr *cmsg;
+    union
+    {
+        struct cmsghdr align;
+        char           buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    ssize_t n;
+    int     memfd = -1;
+
+    iov.iov_base = &msg, iov.iov_len = sizeof(msg);
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov, hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf, hdr.msg_controllen = sizeof(control.buf);
+    n = recvmsg(c->fd, &hdr, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR))
+    {
+        return;
+    }
+    if (n <= 0)
+    {
+        drop_client(c);
+        return;
+    }
+    cmsg = CMSG_FIRSTHDR(&hdr);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET
+        && cmsg->cmsg_type == SCM_RIGHTS)
+    {
+        memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    if (n != sizeof(msg))
+    {
+        msg.type = 0, msg.id = 0;
+    }
+
+    switch (msg.type)
+    {
+    case MOTIOND_ATTACH:
+        if (c->pending || memfd < 0 || attach(c, memfd, msg.size))
+        {
+            send_msg(c, MOTIOND_ERROR, msg.id, 0);
+        }
+        else
+        {
+            send_msg(c, MOTIOND_DONE, msg.id, 0);
+        }
+        break;
+    case MOTIOND_SUBMIT:
+        if (c->pending || !valid_request(c, &msg))
+        {
+            send_msg(c, MOTIOND_ERROR, msg.id, 0);
+        }
+        else
+        {
+            c->req = msg;
+            c->pending = 1;
+        }
+        break;
+    default:
+        send_msg(c, MOTIOND_ERROR, msg.id, 0);
+        break;
+    }
+    if (memfd >= 0)
+    {
+        close(memfd);
+    }
+}
+
+static void load_pairs(void *arg, int first, int end)
+/* Copy the frames first .. end-1 of a batch out of the buffers of the */
+/* clients and estimate their noise. Frame i is the previous (even i)  */
+/* or the current (odd i) frame of pair i/2. The frames that are not   */
+/* going to be filtered are padded at once.                            */
+{
+    BatchJob  *job = arg;
+    DaemonMsg *req;
+    CFrame    *f;
+    uint8     *src;
+    int       i, y;
+
+    for (i = first; i < end; i++)
+    {
+        req = &job->batch[i/2]->req;
+        src = job->batch[i/2]->buf + ((i & 1)? req->curr : req->prev);
+        f = &job->frames[i];
+        for (y = 0; y < f->height; y++)
+        {
+            memcpy(f->pix + y*f->stride, src + y*f->width, f->width);
+        }
+        job->filtered[i] = estimate_noise(f->pix, f->width, f->height,
+                                          f->stride) > NOISE_RATIO;
+        if (!job->filtered[i])
+        {
+            pad_frame(f);
+        }
+    }
+}
+
+static void pad_filtered(void *arg, int first, int end)
+/* Pad the filtered frames first .. end-1 of a batch. */
+{
+    BatchJob *job = arg;
+    int i;
+
+    for (i = first; i < end; i++)
+    {
+        if (job->filtered[i])
+        {
+            pad_frame(&job->frames[i]);
+        }
+    }
+}
+
+static int fits(CFrame *frames, int n)
+/* Check that the frame arena has room for filtering and searching the */
+/* first n pairs of frames.                                            */
+{
+    uint32 room = arena_room(&frame_arena, FRAME_ALIGN);
+
+    return median3x3_pool_bytes(2*n, frames[0].width, frames[0].height) <= room
+           && full_search_pool_bytes(n, &frames[0]) <= room;
+}
+
+static int run_batch(void)
+/* Filter and search the waiting pairs of the size of the first one,    */
+/* starting after the clients of the last batch so that no stream      */
+/* starves, and answer their clients. A batch takes as many pairs as    */
+/* the arenas have room for; the others stay queued for the next one.  */
+/* The pairs of a size there is no room for at all are rejected.       */
+/* Returns the number of pairs answered.                               */
+{
+    Client   *batch[MAX_BATCH], *c;
+    CFrame   frames[2*MAX_BATCH], *prev[MAX_BATCH], *curr[MAX_BATCH];
+    MVector  *mv[MAX_BATCH];
+    uint8    *images[2*MAX_BATCH];
+    int      filtered[2*MAX_BATCH];
+    BatchJob job;
+    uint32   width, height;
+    long     t = get_usec_time();
+    int      n = 0, nf = 0, queued, i, k;
+
+    for (k = 0; k < MAX_CLIENTS && n < MAX_BATCH; k++)
+    {
+        c = &clients[(next_client + k) % MAX_CLIENTS];
+        if (c->fd >= 0 && c->pending
+            && (n == 0 || (c->req.width == batch[0]->req.width
+                           && c->req.height == batch[0]->req.height)))
+        {
+            batch[n++] = c;
+        }
+    }
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    /* The frames are only taken from the pools if they have room for */
+    /* them, as pool_get() exits otherwise, and are given back if the  */
+    /* buffers of the filter and the search do not fit.                */
+    width = batch[0]->req.width, height = batch[0]->req.height;
+    queued = n;
+    k = pool_room(frame_bytes(width, height, FRAME_PAD))/2;
+    n = (k < n)? k : n;
+    for (i = 0; i < 2*n; i++)
+    {
+        alloc_frame(&frames[i], width, height, FRAME_PAD);
+    }
+    for (; n > 0 && !fits(frames, n); n--)
+    {
+        free_frame(&frames[2*n-1]);
+        free_frame(&frames[2*n-2]);
+    }
+    if (n == 0)
+    {
+        for (i = 0; i < queued; i++)
+        {
+            batch[i]->pending = 0;
+            send_msg(batch[i], MOTIOND_ERROR, batch[i]->req.id, 0);
+        }
+        return queued;
+    }
+    next_client = (int) (batch[n-1] - clients + 1) % MAX_CLIENTS;
+    job.batch = batch, job.frames = frames, job.filtered = filtered;
+    pool_run(load_pairs, &job, 2*n);
+    for (i = 0; i < 2*n; i++)
+    {
+        if (filtered[i])
+        {
+            images[nf++] = frames[i].pix;
+        }
+    }
+    median3x3_pool(images, nf, frames[0].width, frames[0].height,
+                   frames[0].stride);
+    pool_run(pad_filtered, &job, 2*n);
+
+    /* The vectors go straight into the buffers of the clients. */
+    for (i = 0; i < n; i++)
+    {
+        prev[i] = &frames[2*i], curr[i] = &frames[2*i+1];
+        mv[i] = (MVector *) (batch[i]->buf + batch[i]->req.mv);
+    }
+    full_search_pool(mv, prev, curr, n);
+    for (i = 2*n-1; i >= 0; i--)
+    {
+        free_frame(&frames[i]);
+    }
+
+    t = get_usec_time() - t;
+    for (i = 0; i < n; i++)
+    {
+        batch[i]->pending = 0;
+        send_msg(batch[i], MOTIOND_DONE, batch[i]->req.id, (uint32) t);
+    }
+    batches++, pairs += n, busy_usec += t;
+    return n;
+}
+
+static void accept_client(int listener)
+{
+    int fd, i;
+
+    if ((fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC)) < 0)
+    {
+        return;
+    }
+    for (i = 0; i < MAX_CLIENTS && clients[i].fd >= 0; i++)
+        ;
+    if (i == MAX_CLIENTS)
+    {
+        close(fd);
+        return;
+    }
+    clients[i].fd = fd;
+}
+
+int main(int argc, char **argv)
+{
+    const char         *path = (argc > 1)? argv[1] : MOTIOND_SOCKET;
+    struct sockaddr_un addr;
+    struct sigaction   sa;
+    struct pollfd      fds[MAX_CLIENTS+1];
+    int                who[MAX_CLIENTS+1];
+    int                listener, n, i, waiting;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        printf("motiond: socket path too long.\n");
+        return 1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr *) &addr, sizeof(addr))
+        || listen(listener, MAX_CLIENTS))
+    {
+        perror("motiond");
+        return 1;
+    }
+
+    ocm_init();
+    pool_init((argc > 2)? atoi(argv[2]) : 0);
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        clients[i].fd = -1;
+    }
+    printf("motiond: serving %s with %d threads.\n", path, pool_threads);
+
+    waiting = 0;
+    while (!quit)
+    {
+        fds[0].fd = listener, fds[0].events = POLLIN;
+        for (n = 1, i = 0; i < MAX_CLIENTS; i++)
+        {
+            if (clients[i].fd >= 0)
+            {
+                fds[n].fd = clients[i].fd, fds[n].events = POLLIN;
+                who[n++] = i;
+            }
+        }
+
+        /* Only look for new pairs if none is waiting for a batch. */
+        if (poll(fds, n, waiting? 0 : -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("motiond");
+            break;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            accept_client(listener);
+        }
+        for (i = 1; i < n; i++)
+        {
+            if (fds[i].revents && clients[who[i]].fd == fds[i].fd)
+            {
+                receive(&clients[who[i]]);
+            }
+        }
+        run_batch();
+        for (waiting = 0, i = 0; i < MAX_CLIENTS; i++)
+        {
+            waiting |= clients[i].fd >= 0 && clients[i].pending;
+        }
+    }
+
+    printf("\nmotiond: %ld pairs in %ld batches, %.1f pairs per batch, "
+           "%.2f ms per batch.\n", pairs, batches,
+           batches? (float) pairs/batches : 0.0f,
+           batches? busy_usec/1000.0/batches : 0.0);
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd >= 0)
+        {
+            drop_client(&clients[i]);
+        }
+    }
+    pool_exit();
+    close(listener);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,57 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : motiond.h                                                     */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Protocol of the host motion-estimation daemon (motiond.c). A client is */
+/*  one stream of frames. It connects to the daemon over a Unix domain     */
+/*  socket (SOCK_SEQPACKET, one DaemonMsg per packet) and attaches a       */
+/*  shared-memory buffer, a memfd passed with SCM_RIGHTS and sealed with   */
+/*  F_SEAL_SHRINK, so that it cannot be truncated under the mapping of the */
+/*  daemon. It then submits pairs of frames that it writes into the        */
+/*  buffer. The daemon copies the frames out of the buffer into padded     */
+/*  frames of its own, since the search needs a border and the filter      */
+/*  works in place, and writes the vector field straight into the buffer:  */
+/*  no pixel goes through the socket, but each pixel is copied once.       */
+/*                                                                         */
+/*      client                          daemon                            */
+/*      MOTIOND_ATTACH + memfd   ->                                        */
+/*      MOTIOND_SUBMIT           ->     filters and searches the pair     */
+/*                               <-     MOTIOND_DONE or MOTIOND_ERROR     */
+/*                                                                         */
+/*  A frame is width*height 8-bit pixels, row after row; the vectors are  */
+/*  (width/MSTEP)*(height/MSTEP) MVectors in the layout of full_search(). */
+/*  A client has at most one pair in flight and must not touch its buffer */
+/*  until the answer arrives. The daemon batches the pairs in flight of   */
+/*  all the clients that have the same frame size. A pair is rejected if  */
+/*  its frames cannot fit in the memory of the daemon, or if it is of a  */
+/*  new size once the daemon has buffers of MAX_POOLS sizes (arena.h).   */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __MOTIOND_H__
+
+#include "image.h"
+#include "motion.h"
+
+/* Default path of the socket. */
+#define MOTIOND_SOCKET "/tmp/motiond.sock"
+
+typedef enum
+{
+    MOTIOND_ATTACH = 1,   /* size: bytes of the buffer, with the memfd    */
+    MOTIOND_SUBMIT,       /* a pair to search                             */
+    MOTIOND_DONE,         /* the vectors of request id are in the buffer  */
+    MOTIOND_ERROR         /* request id was rejected                      */
+} DaemonMsgType;
+
+typedef struct
+{
+    uint32 type;
+    uint32 id;            /* chosen by the client, echoed in the answer   */
+    uint32 width, height;
+    uint32 prev, curr;    /* offsets of the two frames in the buffer      */
+    uint32 mv;            /* offset of the vectors in the buffer          */
+    uint32 size;          /* ATTACH: buffer size, DONE: usec in the daemon*/
+} DaemonMsg;
+
+#define __MOTIOND_H__
+#endif
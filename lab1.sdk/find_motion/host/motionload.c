@@ -0,0 +1,270 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : motionload.c                                                  */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Load generator of the motion-estimation daemon (see motiond.h). Each  */
+/*  stream is a client with a memfd buffer holding one synthetic pair,    */
+/*  which moves by a few pixels and is noisy on every other stream. The  */
+/*  streams keep a pair in flight each until they have submitted pairs   */
+/*  pairs, then the latencies (submission to answer) and the aggregate   */
+/*  throughput are printed. Every answer of a stream must carry the same */
+/*  vectors, since the stream always submits the same pair.              */
+/*                                                                         */
+/*  Usage: motionload [socket [streams [pairs [width height]]]]           */
+/*                                                                         */
+/*  It only needs the headers of the engine: -DHOST_BUILD -I../src.       */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "motiond.h"
+
+/* Largest number of streams. */
+#define MAX_STREAMS 128
+
+typedef struct
+{
+    int     fd;
+    uint8   *buf;         /* prev, curr, then the vectors               */
+    uint32  size;
+    MVector *first;       /* the vectors of the first answer            */
+    long    sent;         /* time of the submission in flight           */
+    int     done;         /* pairs answered                             */
+} Stream;
+
+static Stream streams[MAX_STREAMS];
+
+static long usec_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static void make_frame(uint8 *pix, int width, int height, int dx, int dy,
+                       int noisy)
+/* A smooth pattern shifted by (dx, dy), with impulse noise if noisy. */
+{
+    int x, y, sx, sy;
+
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            sx = x - dx, sy = y - dy;
+            pix[y*width + x] = (uint8) (sx*sx/37 + sy*sy/23 + (sx ^ sy)/3);
+            if (noisy && rand() % 32 == 0)
+            {
+                pix[y*width + x] = (rand() & 1)? 255 : 0;
+            }
+        }
+    }
+}
+
+static int send_msg(Stream *s, DaemonMsg *msg, int memfd)
+/* Send a message, with the memfd if it is not negative. */
+{
+    struct msghdr  hdr;
+    struct iovec   iov;
+    struct cmsghdr *cmsg;
+    union
+    {
+        struct cmsghdr align;
+        char           buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    iov.iov_base = msg, iov.iov_len = sizeof(DaemonMsg);
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov, hdr.msg_iovlen = 1;
+    if (memfd >= 0)
+    {
+        memset(&control, 0, sizeof(control));
+        hdr.msg_control = control.buf;
+        hdr.msg_controllen = sizeof(control.buf);
+        cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+    }
+    return sendmsg(s->fd, &hdr, 0) != sizeof(DaemonMsg);
+}
+
+static int open_stream(Stream *s, const char *path, int k, int width,
+                       int height)
+/* Connect stream k to the daemon and attach its buffer. */
+{
+    struct sockaddr_un addr;
+    DaemonMsg msg;
+    uint32    frame = (uint32) width*height;
+    int       memfd;
+
+    s->size = 2*frame + sizeof(MVector)*(width/MSTEP)*(height/MSTEP);
+    /* The daemon only maps a buffer sealed against shrinking. */
+    memfd = memfd_create("motionload", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0 || ftruncate(memfd, s->size)
+        || fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW))
+    {
+        if (memfd >= 0)
+        {
+            close(memfd);
+        }
+        return 1;
+    }
+    s->buf = mmap(NULL, s->size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (s->buf == MAP_FAILED)
+    {
+        close(memfd);
+        return 1;
+    }
+    make_frame(s->buf, width, height, 0, 0, k & 1);
+    make_frame(s->buf + frame, width, height, k % 7 - 3, k % 5 - 2, k & 1);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
+    s->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (s->fd < 0 || connect(s->fd, (struct sockaddr *) &addr, sizeof(addr)))
+    {
+        close(memfd);
+        return 1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MOTIOND_ATTACH, msg.size = s->size;
+    if (send_msg(s, &msg, memfd)
+        || recv(s->fd, &msg, sizeof(msg), 0) != sizeof(msg)
+        || msg.type != MOTIOND_DONE)
+    {
+        close(memfd);
+        return 1;
+    }
+    close(memfd);
+    return 0;
+}
+
+static int submit(Stream *s, int width, int height, uint32 id)
+{
+    DaemonMsg msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MOTIOND_SUBMIT, msg.id = id;
+    msg.width = width, msg.height = height;
+    msg.prev = 0, msg.curr = (uint32) width*height;
+    msg.mv = 2*msg.curr;
+    s->sent = usec_time();
+    return send_msg(s, &msg, -1);
+}
+
+static int compare_long(const void *a, const void *b)
+{
+    long x = *(const long *) a, y = *(const long *) b;
+
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv)
+{
+    const char   *path = (argc > 1)? argv[1] : MOTIOND_SOCKET;
+    int          nstreams = (argc > 2)? atoi(argv[2]) : 16;
+    int          npairs = (argc > 3)? atoi(argv[3]) : 100;
+    int          width = (argc > 5)? atoi(argv[4]) : 720;
+    int          height = (argc > 5)? atoi(argv[5]) : 480;
+    struct pollfd fds[MAX_STREAMS];
+    DaemonMsg    msg;
+    Stream       *s;
+    long         *latency, t0, t, n = 0;
+    int          active, errors = 0, mismatches = 0, i;
+    uint32       vectors;
+
+    nstreams = (nstreams < 1)? 1 : (nstreams > MAX_STREAMS)?
+               MAX_STREAMS : nstreams;
+    npairs = (npairs < 1)? 1 : npairs;
+    vectors = sizeof(MVector)*(width/MSTEP)*(height/MSTEP);
+    latency = malloc(sizeof(long)*nstreams*npairs);
+    for (i = 0; i < nstreams; i++)
+    {
+        if (open_stream(&streams[i], path, i, width, height))
+        {
+            printf("motionload: cannot attach stream %d to %s.\n", i, path);
+            return 1;
+        }
+        streams[i].first = malloc(vectors);
+    }
+
+    t0 = usec_time();
+    for (i = 0; i < nstreams; i++)
+    {
+        submit(&streams[i], width, height, 0);
+        fds[i].fd = streams[i].fd, fds[i].events = POLLIN;
+    }
+    for (active = nstreams; active > 0; )
+    {
+        if (poll(fds, nstreams, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        for (i = 0; i < nstreams; i++)
+        {
+            if (!fds[i].revents)
+            {
+                continue;
+            }
+            s = &streams[i];
+            if (recv(s->fd, &msg, sizeof(msg), 0) != sizeof(msg)
+                || msg.type != MOTIOND_DONE)
+            {
+                errors++;
+                fds[i].fd = -1;
+                active--;
+                continue;
+            }
+            latency[n++] = usec_time() - s->sent;
+            if (s->done == 0)
+            {
+                memcpy(s->first, s->buf + 2*width*height, vectors);
+            }
+            else if (memcmp(s->first, s->buf + 2*width*height, vectors))
+            {
+                mismatches++;
+            }
+            if (++s->done < npairs)
+            {
+                submit(s, width, height, s->done);
+            }
+            else
+            {
+                fds[i].fd = -1;
+                active--;
+            }
+        }
+    }
+    t = usec_time() - t0;
+
+    qsort(latency, n, sizeof(long), compare_long);
+    printf("%d streams of %dx%d, %ld pairs in %.1f ms: %.1f pairs/s.\n",
+           nstreams, width, height, n, t/1000.0, n*1e6/(t > 0? t : 1));
+    if (n > 0)
+    {
+        printf("latency p50 %.2f ms, p99 %.2f ms, max %.2f ms.\n",
+               latency[n/2]/1000.0, latency[((n-1)*99)/100]/1000.0,
+               latency[n-1]/1000.0);
+    }
+    if (errors || mismatches)
+    {
+        printf("%d errors, %d answers with different vectors!\n",
+               errors, mismatches);
+    }
+    return errors || mismatches;
+}
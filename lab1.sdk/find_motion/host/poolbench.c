@@ -0,0 +1,210 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : poolbench.c                                                   */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Scaling of the thread pool (pool.h). The frames 1.pgm .. count.pgm   */
+/*  of a FAT image (see diskfile.h) are filtered and searched serially,  */
+/*  then with median3x3_pool() and full_search_pool() on 1, 2, 4, ...    */
+/*  threads up to max_threads, one per CPU by default. Every run prints   */
+/*  its time, speedup, efficiency and steals, and whether its vectors    */
+/*  are identical to the serial ones, as they must be for any number of  */
+/*  threads. The frames are filtered if they are noisy, as by the engine; */
+/*  give 1 as the last argument to filter them all.                      */
+/*                                                                         */
+/*  Usage: poolbench image [count [max_threads [filter_all]]]             */
+/*                                                                         */
+/*  Build it like motiond.c.                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#define _GNU_SOURCE
+#include <time.h>
+#include "diskfile.h"
+#include "median.h"
+#include "motion.h"
+#include "pool.h"
+#include "ff.h"
+
+/* Largest and default number of frames. */
+#define POOL_FRAMES 8
+
+/* A frame is filtered if more than NOISE_RATIO percent of the pixels */
+/* examined by estimate_noise() are impulses, as in find_motion.c.    */
+#define NOISE_RATIO 0.5f
+
+long get_usec_time()
+/* Microsecond clock of the volume locks and of the timings. */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static void pad_frames(void *arg, int first, int end)
+/* Pad the frames first .. end-1 of an array of frame pointers. */
+{
+    CFrame **frames = arg;
+    int i;
+
+    for (i = first; i < end; i++)
+    {
+        pad_frame(frames[i]);
+    }
+}
+
+static long pool_pass(CFrame *src, CFrame *dst, int *filtered, int count,
+                      MVector **mv, int pooled)
+/* Copy the frames src into dst, filter the noisy ones and search the   */
+/* count-1 pairs, serially or with the thread pool. Returns the time in */
+/* microseconds, without the copies.                                    */
+{
+    CFrame *noisy[POOL_FRAMES], *prev[POOL_FRAMES], *curr[POOL_FRAMES];
+    uint8  *images[POOL_FRAMES];
+    long   t;
+    int    nnoisy = 0, i;
+
+    for (i = 0; i < count; i++)
+    {
+        memcpy(dst[i].mem, src[i].mem,
+               (size_t) dst[i].stride*(dst[i].height + 2*dst[i].pad));
+        if (filtered[i])
+        {
+            noisy[nnoisy] = &dst[i];
+            images[nnoisy++] = dst[i].pix;
+        }
+        if (i > 0)
+        {
+            prev[i-1] = &dst[i-1], curr[i-1] = &dst[i];
+        }
+    }
+
+    t = get_usec_time();
+    if (pooled)
+    {
+        median3x3_pool(images, nnoisy, dst[0].width, dst[0].height,
+                       dst[0].stride);
+        pool_run(pad_frames, noisy, nnoisy);
+        full_search_pool(mv, prev, curr, count-1);
+    }
+    else
+    {
+        for (i = 0; i < nnoisy; i++)
+        {
+            median3x3(images[i], dst[0].width, dst[0].height, dst[0].stride);
+            pad_frame(noisy[i]);
+        }
+        for (i = 0; i < count-1; i++)
+        {
+            full_search(mv[i], prev[i], curr[i]);
+        }
+    }
+    return get_usec_time() - t;
+}
+
+static int read_frames(CFrame *frames, int count, int filter_all,
+                       int *filtered)
+/* Read 1.pgm .. count.pgm up to the first missing one or the first of */
+/* another size. Returns the number of frames read.                    */
+{
+    char name[32];
+    int  n;
+
+    for (n = 0; n < count; n++)
+    {
+        sprintf(name, "%d.pgm", n+1);
+        if (read_pnm_frame(name, &frames[n], FRAME_PAD))
+        {
+            break;
+        }
+        if (frames[n].width != frames[0].width
+            || frames[n].height != frames[0].height)
+        {
+            free_frame(&frames[n]);
+            break;
+        }
+        filtered[n] = filter_all
+                      || estimate_noise(frames[n].pix, frames[n].width,
+                                        frames[n].height, frames[n].stride)
+                         > NOISE_RATIO;
+    }
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    static FATFS fatfs;
+    CFrame  frames[POOL_FRAMES], work[POOL_FRAMES];
+    MVector *serial[POOL_FRAMES], *mv[POOL_FRAMES];
+    int     filtered[POOL_FRAMES];
+    long    t, t1 = 1;
+    int     count, n, i, threads, max_threads, same, errors = 0;
+    int32   size;
+
+    if (argc < 2)
+    {
+        printf("Usage: poolbench image [count [max_threads [filter_all]]]\n");
+        return 1;
+    }
+    count = (argc > 2)? atoi(argv[2]) : POOL_FRAMES;
+    count = (count > POOL_FRAMES)? POOL_FRAMES : count;
+    if (diskfile_open(argv[1], 0, 0) || f_mount(&fatfs, "0:/", 1))
+    {
+        printf("poolbench: cannot mount the image '%s'.\n", argv[1]);
+        return 1;
+    }
+
+    /* Load the frames once; every pass filters copies of them. */
+    n = read_frames(frames, count, argc > 4 && atoi(argv[4]), filtered);
+    if (n < 2)
+    {
+        printf("poolbench: need two frames 1.pgm, 2.pgm of the same size.\n");
+        return 1;
+    }
+    size = sizeof(MVector)*(frames[0].width/MSTEP)*(frames[0].height/MSTEP);
+    for (i = 0; i < n; i++)
+    {
+        alloc_frame(&work[i], frames[i].width, frames[i].height, FRAME_PAD);
+    }
+    for (i = 0; i < n-1; i++)
+    {
+        serial[i] = get_memory("mv", size);
+        mv[i] = get_memory("mv", size);
+    }
+
+    t = pool_pass(frames, work, filtered, n, serial, 0);
+    max_threads = pool_init((argc > 3)? atoi(argv[3]) : 0);
+    printf("Thread pool on %d frames of %ldx%ld, up to %d threads:\n\n",
+           n, (long) frames[0].width, (long) frames[0].height, max_threads);
+    printf("threads        ms   speedup  efficiency   steals  vectors\n");
+    printf("serial  %9.1f\n", t/1000.0);
+    for (threads = 1; ; threads = (2*threads < max_threads)?
+                                   2*threads : max_threads)
+    {
+        pool_init(threads);
+        for (i = 0; i < n-1; i++)
+        {
+            memset(mv[i], 0, size);
+        }
+        t = pool_pass(frames, work, filtered, n, mv, 1);
+        t = (t > 0)? t : 1;
+        if (threads == 1)
+        {
+            t1 = t;
+        }
+        for (same = 1, i = 0; i < n-1; i++)
+        {
+            same &= !memcmp(mv[i], serial[i], size);
+        }
+        errors += !same;
+        printf("%7d %9.1f %9.2f %10.1f%% %8ld  %s\n", threads, t/1000.0,
+               (float) t1/t, 100.0f*t1/t/threads, pool_steals(),
+               same? "identical" : "DIFFERENT");
+        if (threads == max_threads)
+        {
+            break;
+        }
+    }
+    pool_exit();
+    diskfile_close();
+    return errors != 0;
+}
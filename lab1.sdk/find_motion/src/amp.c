@@ -0,0 +1,327 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : amp.c                                                         */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  CPU1 start-up and the job handoff between the two cores.               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "amp.h"
+#include "ocm.h"
+
+typedef struct
+{
+    volatile uint32 posted;   /* job count, incremented by CPU0          */
+    volatile uint32 done;     /* set to posted by CPU1 when finished     */
+    volatile uint32 alive;    /* set by CPU1 once it runs C code         */
+    volatile long   usec;     /* time CPU1 spent in the last job         */
+    AmpJob job;
+    void   *arg;
+    int    first, end;        /* the items of CPU1                        */
+} AmpControl;
+
+int amp_cores = 1;
+
+static AmpControl *volatile control;
+
+#ifndef HOST_BUILD
+#include "xparameters.h"
+#include "xil_io.h"
+#include "xil_cache.h"
+#include "xpseudo_asm.h"
+#include "xtime_l.h"
+
+/* The boot ROM parks CPU1 in a WFE loop until this word is non-zero, */
+/* then jumps to the address it holds.                                */
+#define CPU1_START_ADDR 0xFFFFFFF0
+
+/* How long to wait for CPU1 to come up. */
+#define CPU1_TIMEOUT_USEC 100000
+
+#define sev() __asm__ __volatile__("sev" : : : "memory")
+#define wfe() __asm__ __volatile__("wfe" : : : "memory")
+
+#define AMP_STR(x)  AMP_STR2(x)
+#define AMP_STR2(x) #x
+
+static uint8 amp_stack[AMP_STACK_SIZE] __attribute__((aligned(8)));
+
+void amp_main(void);
+
+/* Entry point of CPU1, coming out of the boot ROM with the MMU and the */
+/* caches off. This is the part of boot.S that concerns one core: the  */
+/* caches and TLBs are invalidated, the MMU table of CPU0 is used, the */
+/* core joins the coherency domain (ACTLR.SMP) before its caches are   */
+/* enabled, and VFP/NEON are turned on. The SCU and the L2 cache are   */
+/* already set up by CPU0.                                             */
+__asm__(
+"   .section .text.amp_start, \"ax\"\n"
+"   .arm\n"
+"   .global amp_start\n"
+"   .type   amp_start, %function\n"
+"amp_start:\n"
+"   cpsid   if\n"
+"   ldr     r0, =_vector_table\n"
+"   mcr     p15, 0, r0, c12, c0, 0\n"      /* VBAR                        */
+"   mov     r0, #0\n"
+"   mcr     p15, 0, r0, c8, c7, 0\n"       /* invalidate the TLBs         */
+"   mcr     p15, 0, r0, c7, c5, 0\n"       /* invalidate the I-cache      */
+"   mcr     p15, 0, r0, c7, c5, 6\n"       /* and the branch predictor    */
+"   mov     r2, #0\n"                      /* invalidate the 32KB D-cache */
+"1: mov     r3, #0\n"                      /* by set/way: 4 ways of 256   */
+"2: orr     r0, r2, r3\n"                  /* sets of 32-byte lines       */
+"   mcr     p15, 0, r0, c7, c6, 2\n"
+"   add     r3, r3, #0x20\n"
+"   cmp     r3, #0x2000\n"
+"   bne     2b\n"
+"   adds    r2, r2, #0x40000000\n"
+"   bne     1b\n"
+"   dsb\n"
+"   ldr     sp, =amp_stack + " AMP_STR(AMP_STACK_SIZE) "\n"
+"   ldr     r0, =MMUTable\n"
+"   orr     r0, r0, #0x5B\n"               /* outer-cacheable, WB         */
+"   mcr     p15, 0, r0, c2, c0, 0\n"       /* TTBR0                       */
+"   mvn     r0, #0\n"
+"   mcr     p15, 0, r0, c3, c0, 0\n"       /* all domains are managers    */
+"   mrc     p15, 0, r0, c1, c0, 1\n"
+"   orr     r0, r0, #0x41\n"               /* ACTLR.SMP and ACTLR.FW      */
+"   mcr     p15, 0, r0, c1, c0, 1\n"
+"   ldr     r0, =0x1005\n"                 /* MMU, D-cache and I-cache    */
+"   mcr     p15, 0, r0, c1, c0, 0\n"
+"   dsb\n"
+"   isb\n"
+"   mrc     p15, 0, r0, c1, c0, 2\n"
+"   orr     r0, r0, #(0xf << 20)\n"        /* access to CP10 and CP11     */
+"   mcr     p15, 0, r0, c1, c0, 2\n"
+"   isb\n"
+"   mov     r0, #0x40000000\n"
+"   vmsr    fpexc, r0\n"                   /* enable VFP and NEON         */
+"   bl      amp_main\n"
+"3: wfe\n"
+"   b       3b\n"
+"   .ltorg\n"
+"   .text\n"
+);
+
+extern void amp_start(void);
+
+static long usec_time(void)
+{
+    XTime t;
+
+    XTime_GetTime(&t);
+    return (long) (t / (XPAR_CPU_CORTEXA9_CORE_CLOCK_FREQ_HZ / 2000000));
+}
+
+void amp_main(void)
+/* The job loop of CPU1. */
+{
+    uint32 seen = 0;
+    long   t;
+
+    control->alive = 1;
+    dsb();
+    sev();
+    for (;;)
+    {
+        while (control->posted == seen)
+        {
+            wfe();
+        }
+        dmb();
+        seen = control->posted;
+        t = usec_time();
+        control->job(control->arg, control->first, control->end);
+        control->usec = usec_time() - t;
+
+        /* The results must be visible before the job is marked done. */
+        dmb();
+        control->done = seen;
+        dsb();
+        sev();
+    }
+}
+
+static int start_cpu1(void)
+{
+    long t;
+
+    Xil_Out32(CPU1_START_ADDR, (u32) amp_start);
+    Xil_DCacheFlushRange(CPU1_START_ADDR, 4);
+    dsb();
+    sev();
+    for (t = usec_time(); !control->alive; )
+    {
+        if (usec_time() - t > CPU1_TIMEOUT_USEC)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void post_job(void)
+{
+    dmb();
+    control->posted++;
+    dsb();
+    sev();
+}
+
+static void wait_job(void)
+{
+    while (control->done != control->posted)
+    {
+        wfe();
+    }
+    dmb();
+}
+#else
+#include <pthread.h>
+#include <time.h>
+
+static pthread_t       cpu1;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  posted_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  done_cond = PTHREAD_COND_INITIALIZER;
+
+static long usec_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1000000L + ts.tv_nsec/1000;
+}
+
+static void *amp_main(void *unused)
+/* The job loop of the thread standing in for CPU1. */
+{
+    uint32 seen = 0;
+    long   t;
+
+    pthread_mutex_lock(&lock);
+    control->alive = 1;
+    for (;;)
+    {
+        while (control->posted == seen)
+        {
+            pthread_cond_wait(&posted_cond, &lock);
+        }
+        seen = control->posted;
+        pthread_mutex_unlock(&lock);
+        t = usec_time();
+        control->job(control->arg, control->first, control->end);
+        pthread_mutex_lock(&lock);
+        control->usec = usec_time() - t;
+        control->done = seen;
+        pthread_cond_signal(&done_cond);
+    }
+    return NULL;
+}
+
+static int start_cpu1(void)
+{
+    return pthread_create(&cpu1, NULL, amp_main, NULL) != 0;
+}
+
+static void post_job(void)
+{
+    pthread_mutex_lock(&lock);
+    control->posted++;
+    pthread_cond_signal(&posted_cond);
+    pthread_mutex_unlock(&lock);
+}
+
+static void wait_job(void)
+{
+    pthread_mutex_lock(&lock);
+    while (control->done != control->posted)
+    {
+        pthread_cond_wait(&done_cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+#endif
+
+int amp_init(void)
+/* Start CPU1 with its control block in the OCM. Returns 1 and leaves  */
+/* amp_cores at 1 if CPU1 does not answer; jobs then run on CPU0 only. */
+{
+    if (amp_cores == 2)
+    {
+        return 0;
+    }
+    control = ocm_alloc("amp control", sizeof(AmpControl));
+    memset(control, 0, sizeof(AmpControl));
+    if (start_cpu1())
+    {
+        printf("amp_init: CPU1 does not answer.\n");
+        return 1;
+    }
+    amp_cores = 2;
+    return 0;
+}
+
+int amp_split(int count)
+/* The first item of CPU1. The items are assumed to cost the same, so  */
+/* each core gets a contiguous half.                                   */
+{
+    return (amp_cores == 2)? (count + 1)/2 : count;
+}
+
+void amp_post(AmpJob job, void *arg, int first, int end)
+/* Let CPU1 run the items first .. end-1 of the job while CPU0 goes on. */
+/* Without CPU1 the job is run right away. Only one job can be posted  */
+/* at a time; amp_wait() waits for it.                                 */
+{
+    if (amp_cores < 2)
+    {
+        job(arg, first, end);
+        return;
+    }
+    control->job = job, control->arg = arg;
+    control->first = first, control->end = end;
+    post_job();
+}
+
+void amp_wait(void)
+{
+    if (amp_cores == 2)
+    {
+        wait_job();
+    }
+}
+
+void amp_run(AmpJob job, void *arg, int count)
+/* Run the items 0 .. count-1 of the job, split between the cores, and */
+/* return once both are done.                                          */
+{
+    int split = amp_split(count);
+
+    if (split == count)
+    {
+        job(arg, 0, count);
+        return;
+    }
+    amp_post(job, arg, split, count);
+    job(arg, 0, split);
+    amp_wait();
+}
+
+long amp_cpu1_usec(void)
+/* Time CPU1 spent in the last job, in microseconds. */
+{
+    return (amp_cores == 2)? control->usec : 0;
+}
+
+int amp_cpu_id(void)
+/* The core running the caller, 0 or 1. Always 0 on the host. */
+{
+#ifndef HOST_BUILD
+    uint32 mpidr;
+
+    __asm__ __volatile__("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+    return mpidr & 0x3;
+#else
+    return 0;
+#endif
+}
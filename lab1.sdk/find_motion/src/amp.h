@@ -0,0 +1,44 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : amp.h                                                         */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Data-parallel jobs on both A9 cores. amp_init() releases CPU1 from    */
+/*  the boot ROM, which then runs amp_run() jobs out of a control block   */
+/*  in the OCM: CPU0 posts the job and the range of items given to CPU1,  */
+/*  runs its own range, and waits for CPU1 to mark the job done. CPU1     */
+/*  shares the MMU table of CPU0, whose DDR and OCM sections are          */
+/*  shareable, so with the SMP bit set its L1 cache is kept coherent with */
+/*  CPU0 by the SCU and the results need no cache maintenance, only the   */
+/*  barriers around the handoff.                                          */
+/*                                                                         */
+/*  A job must not allocate memory or print, as CPU1 runs with none of    */
+/*  the BSP set up. Of the hardware it may only use the SD card, through  */
+/*  FatFs under the volume lock (fslock.h) once CPU0 has mounted the      */
+/*  volume, and the SGI doorbells of gic.h, which it takes with the IRQs  */
+/*  masked. On the host (HOST_BUILD) CPU1 is a thread, which runs the     */
+/*  same jobs on the same split.                                          */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __AMP_H__
+
+#include "image.h"
+
+/* Stack of CPU1. */
+#define AMP_STACK_SIZE (16*1024)
+
+/* Runs the items first .. end-1 of a job. */
+typedef void (*AmpJob)(void *arg, int first, int end);
+
+/* 2 once CPU1 answers, 1 otherwise. */
+extern int amp_cores;
+
+int  amp_init(void);
+int  amp_split(int count);
+void amp_run(AmpJob job, void *arg, int count);
+void amp_post(AmpJob job, void *arg, int first, int end);
+void amp_wait(void);
+long amp_cpu1_usec(void);
+int  amp_cpu_id(void);
+
+#define __AMP_H__
+#endif
@@ -0,0 +1,225 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : arena.c                                                       */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Bump-pointer arenas and fixed-size frame buffer pools.                 */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "arena.h"
+#include "telemetry.h"
+
+typedef struct
+{
+    uint32 block;     /* block size, a multiple of FRAME_ALIGN           */
+    void   *free;     /* list of returned blocks, linked by first word  */
+    int32  count;     /* blocks taken from the pool arena               */
+    int32  live;      /* blocks currently in use                        */
+    int32  peak;
+} Pool;
+
+Arena frame_arena = { "frame", FRAME_ARENA_SIZE };
+
+Arena pool_arena = { "pool", POOL_ARENA_SIZE };
+static Pool  pools[MAX_POOLS];
+static int   npools;
+
+static void untag_blocks(Arena *arena, uint32 mark)
+/* Release the tags of the blocks from offset mark on. */
+{
+    ArenaBlock *block;
+
+    while (arena->nblocks > 0)
+    {
+        block = &arena->blocks[arena->nblocks-1];
+        if (block->offset < mark)
+        {
+            break;
+        }
+        tag_free(block->tag, block->size);
+        arena->nblocks--;
+    }
+}
+
+void arena_init(Arena *arena, void *base, uint32 size)
+/* Let the arena hand out the memory block at base instead of the heap. */
+{
+    untag_blocks(arena, 0);
+    arena->base = base;
+    arena->size = size;
+    arena->used = arena->peak = 0;
+}
+
+void *arena_alloc(Arena *arena, const char *name, uint32 size, uint32 align)
+/* Allocate size bytes aligned to align, a power of two, from the arena. */
+/* Exits if the arena is full.                                           */
+{
+    ArenaBlock *block;
+    size_t addr;
+
+    if (arena->base == NULL)
+    {
+        if ((arena->base = malloc(arena->size)) == NULL)
+        {
+            printf("arena_alloc: No memory for arena '%s'!\n", arena->name);
+            exit(1);
+        }
+    }
+    addr = ((size_t) arena->base + arena->used + align-1) & ~((size_t) align-1);
+    if (addr + size > (size_t) arena->base + arena->size)
+    {
+        printf("arena_alloc: No memory in arena '%s' for '%s'!\n",
+               arena->name, name);
+        exit(1);
+    }
+    size = (uint32) (addr + size - (size_t) arena->base) - arena->used;
+    if (arena->nblocks < ARENA_BLOCKS)
+    {
+        block = &arena->blocks[arena->nblocks++];
+        block->offset = (uint32) (addr - (size_t) arena->base);
+        block->size = 0;
+        block->tag = mem_tag(name);
+    }
+    else
+    {
+        block = &arena->blocks[ARENA_BLOCKS-1];
+    }
+    block->size += size;
+    tag_alloc(block->tag, size);
+    arena->used += size;
+    if (arena->used > arena->peak)
+    {
+        arena->peak = arena->used;
+    }
+    return (void *) addr;
+}
+
+uint32 arena_mark(Arena *arena)
+{
+    return arena->used;
+}
+
+uint32 arena_room(Arena *arena, uint32 align)
+/* Bytes that an arena_alloc() aligned to align can still get without */
+/* exiting, whatever the alignment of the free space.                 */
+{
+    uint32 used = arena->used + align-1;
+
+    return (used < arena->size)? arena->size - used : 0;
+}
+
+void arena_release(Arena *arena, uint32 mark)
+/* Free everything allocated since arena_mark() returned mark. */
+{
+    if (mark < arena->used)
+    {
+        untag_blocks(arena, mark);
+        arena->used = mark;
+    }
+}
+
+void arena_reset(Arena *arena)
+{
+    untag_blocks(arena, 0);
+    arena->used = 0;
+}
+
+static Pool *find_pool(uint32 block)
+{
+    int i;
+
+    for (i = 0; i < npools; i++)
+    {
+        if (pools[i].block == block)
+        {
+            return &pools[i];
+        }
+    }
+    return NULL;
+}
+
+void *pool_get(const char *name, uint32 size)
+/* Get a block of at least size bytes, aligned to FRAME_ALIGN, from the */
+/* pool of blocks of that size. A new pool is set up for a new size.   */
+{
+    Pool *pool;
+    void *block;
+
+    size = (size + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    if ((pool = find_pool(size)) == NULL)
+    {
+        if (npools == MAX_POOLS)
+        {
+            printf("pool_get: Too many buffer sizes for '%s'!\n", name);
+            exit(1);
+        }
+        pool = &pools[npools++];
+        pool->block = size;
+    }
+    if (pool->free != NULL)
+    {
+        block = pool->free;
+        pool->free = *(void **) block;
+    }
+    else
+    {
+        block = arena_alloc(&pool_arena, name, size, FRAME_ALIGN);
+        pool->count++;
+    }
+    if (++pool->live > pool->peak)
+    {
+        pool->peak = pool->live;
+    }
+    return block;
+}
+
+void pool_put(void *block, uint32 size)
+/* Return a block obtained from pool_get() with the same size. */
+{
+    Pool *pool;
+
+    size = (size + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    if (block == NULL || (pool = find_pool(size)) == NULL)
+    {
+        return;
+    }
+    *(void **) block = pool->free;
+    pool->free = block;
+    pool->live--;
+}
+
+int32 pool_room(uint32 size)
+/* Number of blocks of size bytes that pool_get() can still hand out    */
+/* without exiting: the free blocks of their pool and the blocks there  */
+/* is room for in the pool arena. 0 for a new size if there are         */
+/* MAX_POOLS sizes already.                                             */
+{
+    Pool *pool;
+
+    size = (size + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    pool = find_pool(size);
+    if (size == 0 || (pool == NULL && npools == MAX_POOLS))
+    {
+        return 0;
+    }
+    return ((pool != NULL)? pool->count - pool->live : 0)
+           + (int32) (arena_room(&pool_arena, FRAME_ALIGN)/size);
+}
+
+void report_memory(void)
+/* Print the peak usage of the arenas and of the frame buffer pools. */
+{
+    int i;
+
+    printf("Arena '%s': peak %lu KB of %lu KB.\n", frame_arena.name,
+           (unsigned long) frame_arena.peak/1024,
+           (unsigned long) frame_arena.size/1024);
+    printf("Arena '%s': peak %lu KB of %lu KB.\n", pool_arena.name,
+           (unsigned long) pool_arena.peak/1024,
+           (unsigned long) pool_arena.size/1024);
+    for (i = 0; i < npools; i++)
+    {
+        printf("  pool of %lu KB buffers: %ld allocated, at most %ld in use.\n",
+               (unsigned long) pools[i].block/1024, pools[i].count,
+               pools[i].peak);
+    }
+}
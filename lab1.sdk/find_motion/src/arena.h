@@ -0,0 +1,74 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : arena.h                                                       */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Memory management of the engine. Each arena hands out one block of    */
+/*  memory by bumping an offset. The block is either given to the arena   */
+/*  with arena_init() or taken from the newlib heap (capped by _HEAP_SIZE */
+/*  in lscript.ld) on the first allocation:                                */
+/*                                                                         */
+/*      frame_arena : everything allocated while a frame pair is being    */
+/*                    processed, through get_memory(). A stage releases   */
+/*                    its temporaries with release_memory(), which frees  */
+/*                    a block and all the blocks allocated after it, and  */
+/*                    arena_reset() frees the rest once the frame is done.*/
+/*      pool arena  : the frame buffers, which are recycled through       */
+/*                    fixed-size pools (pool_get/pool_put), so a sequence */
+/*                    of frames of the same size never goes back to the   */
+/*                    heap and cannot fragment it.                        */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __ARENA_H__
+
+#include "image.h"
+
+/* Sizes of the arenas, in bytes. Both must fit in the heap together.     */
+#ifndef FRAME_ARENA_SIZE
+#define FRAME_ARENA_SIZE (8*1024*1024)
+#endif
+#ifndef POOL_ARENA_SIZE
+#define POOL_ARENA_SIZE  (20*1024*1024)
+#endif
+
+/* Maximum number of distinct frame buffer sizes. */
+#define MAX_POOLS 8
+
+/* Maximum number of live blocks per arena whose tags are tracked for  */
+/* the telemetry. Later blocks are charged to the last tracked block.  */
+#define ARENA_BLOCKS 64
+
+typedef struct
+{
+    uint32 offset;    /* start of the block in the arena                */
+    uint32 size;      /* bytes up to the end of the block               */
+    int    tag;       /* see mem_tag() in telemetry.h                   */
+} ArenaBlock;
+
+typedef struct
+{
+    const char *name;
+    uint32 size;      /* capacity of the arena                          */
+    uint8  *base;     /* NULL until the first allocation                */
+    uint32 used;      /* offset of the first free byte                  */
+    uint32 peak;      /* high-water mark of used                        */
+    int    nblocks;   /* live blocks, in allocation order               */
+    ArenaBlock blocks[ARENA_BLOCKS];
+} Arena;
+
+extern Arena frame_arena, pool_arena;
+
+void   arena_init(Arena *arena, void *base, uint32 size);
+void  *arena_alloc(Arena *arena, const char *name, uint32 size, uint32 align);
+uint32 arena_mark(Arena *arena);
+uint32 arena_room(Arena *arena, uint32 align);
+void   arena_release(Arena *arena, uint32 mark);
+void   arena_reset(Arena *arena);
+
+void  *pool_get(const char *name, uint32 size);
+void   pool_put(void *block, uint32 size);
+int32  pool_room(uint32 size);
+
+void   report_memory(void);
+
+#define __ARENA_H__
+#endif
@@ -9,8 +9,22 @@
 /* /////////////////////////////////////////////////////////////////////// */
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
 #include "image.h"
+#include "arena.h"
+#include "ocm.h"
+#include "gic.h"
+#include "prefetch.h"
+#include "region.h"
+#include "telemetry.h"
+#include "amp.h"
+#include "pipeline.h"
+#include "task.h"
+#include "pool.h"
+#include "mailbox.h"
+#include "fslock.h"
+#include "median.h"
+#include "prefilter.h"
+#include "motion.h"
 
 #include "xparameters.h"  /* SDK generated parameters */
 #include "xsdps.h"        /* for SD device driver     */
@@ -18,6 +32,8 @@
 #include "xil_cache.h"
 #include "xplatform_info.h"
 #include "xtime_l.h"
+#include "xpm_counter.h"
+#include "xl2cc_counter.h"
 
 #include "xgpiops.h"
 #define LED 7            /* The LED of PS7 on Zed connects to pin 7     */
@@ -36,17 +52,121 @@ long get_usec_time()
 	return (long) (time_tick / COUNTS_PER_USECOND);
 }
 
-#define BSIZE 16  /* Block size for motion estimation */
-#define MSTEP  8  /* Step size between motion vectors */
+/* The prefilter used for noise removal, see prefilters[] in prefilter.c. */
+/* On the host it can also be given as the first command-line argument.   */
+#define PREFILTER "median3"
 
-typedef struct {
-    int8 x;
-    int8 y;
-} MVector;
+/* Set to 1 to median filter the frames row by row just ahead of motion  */
+/* estimation instead of filtering both frames first. This only applies  */
+/* to the "median3" prefilter.                                            */
+#define STREAMING 0
+
+/* Set to 1 to read the frames from the files row by row while they are */
+/* filtered and searched (see file_search()), for frames too large to   */
+/* be held in memory, such as 4K or 8K frames. Only the noise estimate  */
+/* and the motion field are printed in this mode.                       */
+#define FILE_STREAMING 0
+
+/* Number of rows of a streamed frame used to estimate its noise.        */
+#define NOISE_ROWS 64
+
+/* Set to 1 to search the blocks in vertical strips with a sliding      */
+/* reference window (see strip_search()) instead of in raster order.    */
+#define STRIP_SEARCH 0
+
+/* Set to 1 to stream the rows of both frames into the OCM with the DMA */
+/* controller while the blocks are searched (see prefetch_search()).    */
+/* If the rows of the frames do not fit, the search falls back to the  */
+/* one STRIP_SEARCH selects.                                           */
+#define DMA_PREFETCH 0
+
+/* Set to 1 to start CPU1 and split the rows of the median3 prefilter  */
+/* and the block rows of the full search between both cores (see      */
+/* amp.h). This takes precedence over DMA_PREFETCH and STRIP_SEARCH.  */
+#define AMP_CORES 0
+
+/* Set to the number of frames of a sequence 1.pgm, 2.pgm, ... to run  */
+/* the two-core pipeline of pipeline.h on it: CPU1 reads and filters  */
+/* the next frame while CPU0 searches the current pair.               */
+#define PIPELINE_FRAMES 0
+
+/* Set to 1 to estimate the motion of every pair of consecutive frames */
+/* of the sequence 0001.pgm, 0002.pgm, ... up to the first missing     */
+/* frame, or SEQUENCE_FRAMES frames, and print the vector field of     */
+/* each pair. Every frame is read and filtered once and then kept as   */
+/* the reference of the next pair. The next frame is read while the    */
+/* current pair is searched: on CPU1 if AMP_CORES is set, and in a     */
+/* task on CPU0 otherwise.                                             */
+#define SEQUENCE_MODE   0
+#define SEQUENCE_NAME   "%04d.pgm"
+#define SEQUENCE_FRAMES 9999
+
+/* Set to 1 to time the frames 1 .. TASK_FRAMES of a sequence on CPU0  */
+/* alone, first loading and searching in turn, then with the loading   */
+/* in a task that overlaps the SD transfers with the search (task.h).   */
+#define BENCHMARK_TASKS 0
+#define TASK_FRAMES     100
+
+/* Set to 1 to check the vectors of full_search_pool() (pool.h) against */
+/* full_search() on the unfiltered pair. The scaling with the threads   */
+/* is measured on the host by host/poolbench.c.                         */
+#define BENCHMARK_POOL 0
+
+/* Set to 1 to time every prefilter on the first frame before the run.    */
+#define BENCHMARK_PREFILTERS 0
+
+/* Set to 1 to compare the cache misses of the row-major and the tiled   */
+/* frame layouts for median filtering and motion estimation.            */
+#define BENCHMARK_LAYOUTS 0
+
+/* Set to 1 to time strip_search() with its windows in the DDR and in   */
+/* the OCM. Build with -DOCM_KERNELS to run the SAD and median kernels  */
+/* from the OCM as well, and compare the times with a normal build.     */
+#define BENCHMARK_OCM 0
+
+/* Set to 1 to measure the round-trip latency and the throughput of the */
+/* inter-core mailboxes, with CPU1 waiting in WFE and on an SGI.        */
+#define BENCHMARK_MAILBOX 0
+#define MAILBOX_ROUNDS    100000
+
+/* Set to 1 to measure the cost of the FatFs volume lock (fslock.h):    */
+/* a grant without contention, then CPU0 writing FSLOCK_BYTES to a file */
+/* alone and while CPU1 reads 1.pgm FSLOCK_PASSES times, with CPU1     */
+/* waiting for the lock in WFE and on an SGI.                          */
+#define BENCHMARK_FSLOCK 0
+#define FSLOCK_ROUNDS    100000
+#define FSLOCK_CHUNK     (32*1024)
+#define FSLOCK_BYTES     (8*1024*1024)
+#define FSLOCK_PASSES    8
+
+/* A frame is prefiltered if more than NOISE_RATIO percent of the pixels  */
+/* examined by estimate_noise() are impulses.                             */
+#define NOISE_RATIO 0.5f
+
+/* Number of rows filtered to estimate the cost of the prefilter.         */
+#define CALIB_ROWS 16
+
+/* Set force_median to 1 to filter every frame regardless of its noise.   */
+int force_median = 0;
 
 /* function prototypes. */
-void  median3x3(uint8 *image, int width, int height);
-void  full_search(MVector *, uint8 *, uint8 *, int32, int32);
+long  prefilter_cost(const Prefilter *prefilter, CFrame *frame);
+void  benchmark_prefilters(CFrame *frame);
+void  benchmark_layouts(void);
+void  benchmark_ocm(CFrame *frame_1, CFrame *frame_2, MVector *mv);
+void  benchmark_pool(CFrame *frame_1, CFrame *frame_2, MVector *mv);
+void  benchmark_mailbox(void);
+void  benchmark_fslock(void);
+
+/* Mailboxes of the mailbox benchmark, from CPU0 to CPU1 and back. */
+static Mailbox *ping, *pong;
+int   stream_files(const char *name_1, const char *name_2);
+int   pipeline_files(const char *pattern, int count);
+int   sequence_files(const char *pattern, int count);
+int   benchmark_tasks(const char *pattern, int count);
+double frame_traffic(CFrame *frame);
+double search_traffic(int32 width, int32 height, int streaming,
+                      int prefetched, long ddr_bytes);
 void  compute_statistics(float *, float *, float *, MVector *, int32);
 void  print_motion_vectors(MVector *mv, int w, int h);
 
@@ -56,17 +176,67 @@ static FATFS fatfs;
 int main(int argc, char **argv)
 {
 	XGpioPs_Config *gpio_cfg;
-    CImage frame_1, frame_2;
+    const Prefilter *prefilter;
+    CFrame frame_1, frame_2;
     MVector *mv;
     int32 width, height, size;
-    long tcount1, tcount2;
+    long tcount1, tcount2, tnoise, tsaved, tread, ddr_bytes = 0;
     float mean, min, max;
+    float noise_1, noise_2;
+    int filter_1, filter_2, streaming, prefetched = 0;
+    PrefilterFunc run;
+
+    /* Select the prefilter. */
+    prefilter = find_prefilter((argc > 1)? argv[1] : PREFILTER);
+    if (prefilter == NULL)
+    {
+        printf("\nError: unknown prefilter '%s'.\n", (argc > 1)? argv[1] : PREFILTER);
+        return 1;
+    }
+
+    /* Set up the interrupt controller, once for all its users, the OCM */
+    /* scratchpad, the frame buffer memory in sections of its own, CPU1 */
+    /* and the DMA controller. The frames must be shareable for CPU1 to */
+    /* see them through the SCU.                                        */
+    if (gic_init())
+    {
+        return XST_FAILURE;
+    }
+    ocm_init();
+    arena_init(&pool_arena, region_alloc("frame pools", POOL_ARENA_SIZE,
+                                         (AMP_CORES || PIPELINE_FRAMES
+                                          || BENCHMARK_MAILBOX
+                                          || BENCHMARK_FSLOCK)?
+                                         MEM_SHARED : MEM_WRITE_BACK),
+               POOL_ARENA_SIZE);
+    if (BENCHMARK_MAILBOX)
+    {
+        ping = mailbox_create("ping", 16);
+        pong = mailbox_create("pong", 16);
+    }
+    if (AMP_CORES || PIPELINE_FRAMES || BENCHMARK_MAILBOX
+        || BENCHMARK_FSLOCK)
+    {
+        amp_init();
+    }
+    if (BENCHMARK_MAILBOX)
+    {
+        benchmark_mailbox();
+    }
+    if (DMA_PREFETCH && prefetch_init())
+    {
+        return XST_FAILURE;
+    }
 
     /* Initialize the SD card driver. */
 	if (f_mount(&fatfs, "0:/", 0))
 	{
 		return XST_FAILURE;
 	}
+    if (BENCHMARK_FSLOCK)
+    {
+        benchmark_fslock();
+    }
 
     /* Initialize the Zynq PS7 GPIO pins */
     gpio_cfg = XGpioPs_LookupConfig(XPAR_PS7_GPIO_0_DEVICE_ID);
@@ -77,14 +247,32 @@ int main(int argc, char **argv)
     XGpioPs_SetDirectionPin(&Gpio, LED, 1);
     XGpioPs_SetOutputEnablePin(&Gpio, LED, 1);
 
-    /* Read image files into the DDR main memory */
-    if (read_pnm_image("1.pgm", &frame_1))
+    if (FILE_STREAMING)
+    {
+        return stream_files("1.pgm", "2.pgm");
+    }
+    if (PIPELINE_FRAMES)
+    {
+        return pipeline_files("%d.pgm", PIPELINE_FRAMES);
+    }
+    if (SEQUENCE_MODE)
+    {
+        return sequence_files(SEQUENCE_NAME, SEQUENCE_FRAMES);
+    }
+    if (BENCHMARK_TASKS)
+    {
+        return benchmark_tasks("%d.pgm", TASK_FRAMES);
+    }
+
+    /* Read image files into padded frames in the DDR main memory */
+    tcount1 = get_usec_time();
+    if (read_pnm_frame("1.pgm", &frame_1, FRAME_PAD))
     {
         printf("\nError: cannot read input image 1.\n");
     	return 1;
     }
     width = frame_1.width, height = frame_1.height;
-    if (read_pnm_image("2.pgm", &frame_2))
+    if (read_pnm_frame("2.pgm", &frame_2, FRAME_PAD))
     {
         printf("\nError: cannot read input image 2.\n");
         return 1;
@@ -94,15 +282,31 @@ int main(int argc, char **argv)
         printf("\nError: Image sizes of the two frames do not match!\n");
         return 1;
     }
+    tread = get_usec_time() - tcount1;
+    record_stage("read frames", frame_traffic(&frame_1) + frame_traffic(&frame_2),
+                 tread);
 
     /* Allocate space for storing motion vectors */
     size = (width/MSTEP)*(height/MSTEP);
-    if ((mv = malloc(sizeof(MVector)*size)) == NULL)
+    mv = get_memory("mv", sizeof(MVector)*size);
+    memset((char *) mv, 0, sizeof(MVector)*size);
+
+    if (BENCHMARK_PREFILTERS)
     {
-        printf("\nError: Fail to allocate memory for mvx[]!\n");
-        return 1;
+        benchmark_prefilters(&frame_1);
+    }
+    if (BENCHMARK_LAYOUTS)
+    {
+        benchmark_layouts();
+    }
+    if (BENCHMARK_OCM)
+    {
+        benchmark_ocm(&frame_1, &frame_2, mv);
+    }
+    if (BENCHMARK_POOL)
+    {
+        benchmark_pool(&frame_1, &frame_2, mv);
     }
-    memset((char *) mv, 0, sizeof(MVector)*size);
 
     /* Turn on the LED to signal the start of computation. */
     XGpioPs_WritePin(&Gpio, LED, 0x1);
@@ -111,18 +315,77 @@ int main(int argc, char **argv)
     /* Measuring computation time of median filtering. */
     tcount1 = get_usec_time();
 
-    /* Perform median filter for noise removal */
-    median3x3(frame_1.pix, width, height);
-    median3x3(frame_2.pix, width, height);
+    /* Estimate the impulse noise level of both frames. */
+    noise_1 = estimate_noise(frame_1.pix, width, height, frame_1.stride);
+    noise_2 = estimate_noise(frame_2.pix, width, height, frame_2.stride);
+    tnoise = get_usec_time() - tcount1;
+    filter_1 = force_median || noise_1 > NOISE_RATIO;
+    filter_2 = force_median || noise_2 > NOISE_RATIO;
+
+    /* Perform the prefilter for noise removal on the noisy frames, */
+    /* unless it is fused into the motion estimation. The borders   */
+    /* are replicated again from the filtered pixels.               */
+    streaming = STREAMING && !strcmp(prefilter->name, "median3");
+    run = (AMP_CORES && prefilter->run == median3x3)? median3x3_amp
+                                                    : prefilter->run;
+    if (filter_1 && !streaming)
+    {
+        run(frame_1.pix, width, height, frame_1.stride);
+        pad_frame(&frame_1);
+    }
+    if (filter_2 && !streaming)
+    {
+        run(frame_2.pix, width, height, frame_2.stride);
+        pad_frame(&frame_2);
+    }
+
+    tcount1 = get_usec_time() - tcount1;
+    record_stage("noise estimate", 2.0*width*height, tnoise);
+    if ((filter_1 || filter_2) && !streaming)
+    {
+        /* Each filtered pixel is read and written, and so is the border. */
+        record_stage("prefilter", (filter_1 + filter_2)
+                     * 2.0*frame_1.stride*(height + 2*frame_1.pad),
+                     tcount1 - tnoise);
+    }
+
+    /* Estimate the filtering time of the skipped frames, minus the time */
+    /* spent on the noise estimation. This is not part of the timing.    */
+    tsaved = (filter_1 && filter_2)? 0 :
+             (2 - filter_1 - filter_2)
+             * prefilter_cost(prefilter, &frame_1) - tnoise;
 
     /* Measuring computation time of motion estimation. */
-    tcount1 = (tcount2 = get_usec_time()) - tcount1;
+    tcount2 = get_usec_time();
 
     /* Perform full-search motion estimation */
-    full_search(mv, frame_1.pix, frame_2.pix, width, height);
+    if (streaming)
+    {
+        stream_search(mv, &frame_1, &frame_2, filter_1, filter_2);
+    }
+    else if (AMP_CORES)
+    {
+        full_search_amp(mv, &frame_1, &frame_2);
+    }
+    else if (DMA_PREFETCH
+             && !prefetch_search(mv, &frame_1, &frame_2))
+    {
+        prefetched = 1;
+    }
+    else if (STRIP_SEARCH)
+    {
+        ddr_bytes = strip_search(mv, &frame_1, &frame_2);
+    }
+    else
+    {
+        full_search(mv, &frame_1, &frame_2);
+    }
 
     /* End of computation. */
     tcount2 = get_usec_time() - tcount2;
+    record_stage(streaming? "filter+search" : "motion search",
+                 search_traffic(width, height, streaming, prefetched,
+                                ddr_bytes), tcount2);
 
     /* Turn off the LED to signal the end of computation. */
     XGpioPs_WritePin(&Gpio, LED, 0x0);
@@ -132,142 +395,693 @@ int main(int argc, char **argv)
     print_motion_vectors(mv, width/MSTEP, height/MSTEP);
     printf("The motion vectors have a mean of %4.1f pixels.\n", mean);
     printf("The motion vectors range between %4.1f and %4.1f pixels.\n", min, max);
+    printf("Frame 1 has %4.2f%% impulse noise, %s filter %s.\n",
+           noise_1, prefilter->name, filter_1? "applied" : "skipped");
+    printf("Frame 2 has %4.2f%% impulse noise, %s filter %s.\n",
+           noise_2, prefilter->name, filter_2? "applied" : "skipped");
+    printf("It took %ld milliseconds to read the two images, %.2f MB/s.\n",
+           tread/1000, 2.0f*width*height/(tread > 0? tread : 1));
     printf("It took %ld milliseconds to filter the two images.\n", tcount1/1000);
+    if (streaming)
+    {
+        printf("The median filter was fused into the motion estimation.\n");
+    }
+    if (!filter_1 || !filter_2)
+    {
+        printf("Skipping the filter saved about %ld milliseconds.\n",
+               tsaved/1000);
+    }
     printf("It took %ld milliseconds to estimate the motion field.\n", tcount2/1000);
+    if (AMP_CORES && !streaming)
+    {
+        printf("The search ran on %d cores, CPU1 took %ld milliseconds.\n",
+               amp_cores, amp_cpu1_usec()/1000);
+    }
+    if (prefetched)
+    {
+        printf("The frame rows were prefetched into the OCM by DMA.\n");
+    }
+    if (ddr_bytes)
+    {
+        printf("The strip search read %ld KB of the frames from DDR, "
+               "%.2f times the two frames.\n", ddr_bytes/1024,
+               ddr_bytes/(2.0f*width*height));
+    }
 
     /* Free allocated memory */
-    free(frame_1.pix);
-    free(frame_2.pix);
-    free(mv);
+    report_memory();
+    report_regions();
+    report_telemetry();
+    free_frame(&frame_1);
+    free_frame(&frame_2);
+    arena_reset(&frame_arena);
 
     return 0;
 }
 
-void matrix_to_array(uint8 *pix_array, uint8 *ptr, int width)
+static void print_pair(MVector *mv, FrameSlot *prev, FrameSlot *curr,
+                       int number)
+/* Print the statistics of the vectors of one pair of the pipeline. */
+{
+    float mean, min, max;
+
+    compute_statistics(&mean, &min, &max, mv,
+                       (curr->frame.width/MSTEP)*(curr->frame.height/MSTEP));
+    printf("Frames %d-%d: mean %4.1f, range %4.1f to %4.1f pixels%s.\n",
+           number-1, number, mean, min, max,
+           curr->filtered? ", filtered" : "");
+}
+
+int pipeline_files(const char *pattern, int count)
+/* Run the two-core pipeline over the frames 1 .. count of a sequence. */
 {
-    int  idx, x, y;
+    PipelineStats stats;
 
-    idx = 0;
-    for (y = -1; y <= 1; y++)
+    printf("\nBegin pipelined motion estimation on %d cores ...\n\n",
+           amp_cores);
+    XGpioPs_WritePin(&Gpio, LED, 0x1);
+    if (run_pipeline(pattern, 1, count, force_median? -1.0f : NOISE_RATIO,
+                     PIPE_CPU1, print_pair, &stats))
     {
-        for (x = -1; x <= 1; x++)
-        {
-            pix_array[idx++] = *(ptr+x+width*y);
-        }
+        XGpioPs_WritePin(&Gpio, LED, 0x0);
+        return 1;
+    }
+    XGpioPs_WritePin(&Gpio, LED, 0x0);
+    report_pipeline(&stats);
+    report_memory();
+    return 0;
+}
+
+static void print_field(MVector *mv, FrameSlot *prev, FrameSlot *curr,
+                        int number)
+/* Print the statistics and the vector field of one pair of a sequence. */
+{
+    print_pair(mv, prev, curr, number);
+    print_motion_vectors(mv, curr->frame.width/MSTEP,
+                         curr->frame.height/MSTEP);
+}
+
+int sequence_files(const char *pattern, int count)
+/* Estimate the motion between the consecutive frames 1 .. count of a */
+/* sequence, stopping at the first missing frame.                     */
+{
+    PipelineStats stats;
+
+    printf("\nBegin motion estimation of the sequence %s ...\n\n", pattern);
+    XGpioPs_WritePin(&Gpio, LED, 0x1);
+    if (run_pipeline(pattern, 1, count, force_median? -1.0f : NOISE_RATIO,
+                     (amp_cores > 1)? PIPE_CPU1 : PIPE_TASKS, print_field,
+                     &stats))
+    {
+        XGpioPs_WritePin(&Gpio, LED, 0x0);
+        printf("\nError: the sequence needs two frames of the same size.\n");
+        return 1;
     }
+    XGpioPs_WritePin(&Gpio, LED, 0x0);
+    printf("\n");
+    report_pipeline(&stats);
+    report_memory();
+    return 0;
 }
 
-void insertion_sort(uint8 *pix_array, int size)
+int benchmark_tasks(const char *pattern, int count)
+/* Compare the wall-clock time of a sequence on CPU0 with and without */
+/* the loading task.                                                   */
 {
-    int idx, jdx;
-    uint8 temp;
+    PipelineStats serial, tasks;
+    float noise_ratio = force_median? -1.0f : NOISE_RATIO;
 
-    for (idx = 1; idx < size; idx++)
+    printf("\nBegin motion estimation of %d frames on CPU0 ...\n", count);
+    if (run_pipeline(pattern, 1, count, noise_ratio, PIPE_SERIAL, NULL,
+                     &serial)
+        || run_pipeline(pattern, 1, count, noise_ratio, PIPE_TASKS, NULL,
+                        &tasks))
     {
-        for (jdx = idx; jdx > 0; jdx--)
-        {
-            if (pix_array[jdx] < pix_array[jdx-1])
-            {
-                /* swap */
-                temp = pix_array[jdx];
-                pix_array[jdx] = pix_array[jdx-1];
-                pix_array[jdx-1] = temp;
-            }
-        }
+        return 1;
     }
+    printf("\nLoad, then search:\n");
+    report_pipeline(&serial);
+    printf("\nLoading task:\n");
+    report_pipeline(&tasks);
+    report_tasks();
+    printf("\nThe loading task saves %ld ms (%.1f%%) of the wall-clock time.\n",
+           (serial.wall_usec - tasks.wall_usec)/1000,
+           100.0f*(serial.wall_usec - tasks.wall_usec)
+           /((serial.wall_usec > 0)? serial.wall_usec : 1));
+    return 0;
+}
+
+void benchmark_pool(CFrame *frame_1, CFrame *frame_2, MVector *mv)
+/* Search the pair again with full_search_pool() and compare the        */
+/* vectors with those of full_search(). The pool has one thread on the  */
+/* target, so this only checks the pool entry points; host/poolbench.c */
+/* measures how they scale with the threads of a workstation.           */
+{
+    MVector *pooled;
+    CFrame  *prev = frame_1, *curr = frame_2;
+    int32   size;
+    long    t;
+
+    size = sizeof(MVector)*(frame_1->width/MSTEP)*(frame_1->height/MSTEP);
+    pooled = get_memory("benchmark_pool", size);
+    full_search(mv, frame_1, frame_2);
+    t = get_usec_time();
+    full_search_pool(&pooled, &prev, &curr, 1);
+    t = get_usec_time() - t;
+    printf("\nfull_search_pool() on %d thread: %.2f ms, vectors %s.\n",
+           pool_threads, t/1000.0f,
+           memcmp(pooled, mv, size)? "DIFFERENT" : "identical");
+    release_memory(pooled);
+}
+
+double frame_traffic(CFrame *frame)
+/* Bytes moved to read a frame: the file data is moved from where it   */
+/* was read into its rows, and the border of the frame is written.      */
+{
+    return 2.0*frame->width*frame->height
+           + (double) frame->stride*(frame->height + 2*frame->pad)
+           - (double) frame->width*frame->height;
 }
 
-void median3x3(uint8 *image, int width, int height)
+double search_traffic(int32 width, int32 height, int streaming,
+                      int prefetched, long ddr_bytes)
+/* Estimate the bytes the motion search read from memory. The strip   */
+/* search counts them itself. The other searches read the current     */
+/* frame once, and the full search reads the 2*SRANGE+BSIZE reference */
+/* rows of every block row, which do not stay in the L1 cache.        */
 {
-    int   row, col;
-    uint8 pix_array[9], *ptr;
+    double frame = (double) width*height;
 
-    for (row = 1; row < height-1; row++)
+    if (ddr_bytes)
     {
-        for (col = 1; col < width-1; col++)
-        {
-            ptr = image + row*width + col;
-            matrix_to_array(pix_array, ptr, width);
-            insertion_sort(pix_array, 9);
-            *ptr = pix_array[4];
-        }
+        return ddr_bytes;
+    }
+    if (prefetched)
+    {
+        return 2*frame;
+    }
+    if (streaming)
+    {
+        /* Read both frames and write and read the filtered ring lines. */
+        return 2*frame + 2*2*frame;
+    }
+    return frame + frame*(2*SRANGE + BSIZE)/MSTEP;
+}
+
+static int noise_of_file(const char *name, float *noise)
+/* Estimate the impulse noise of an image file from its first NOISE_ROWS */
+/* rows.                                                                  */
+{
+    PnmReader reader;
+    uint8 *band;
+    int rows, error;
+
+    if (open_pnm_rows(name, &reader))
+    {
+        return 1;
+    }
+    rows = (reader.height < NOISE_ROWS)? reader.height : NOISE_ROWS;
+    band = get_memory("noise band", reader.width*rows);
+    error = read_pnm_rows(&reader, band, reader.width, rows);
+    if (!error)
+    {
+        *noise = estimate_noise(band, reader.width, rows, reader.width);
+    }
+    release_memory(band);
+    close_pnm_rows(&reader);
+    return error;
+}
+
+int stream_files(const char *name_1, const char *name_2)
+/* Estimate the motion between two image files without loading them. The */
+/* rows are read, median filtered if the frame is noisy and searched as  */
+/* the search moves down the frames, so the memory used only depends on  */
+/* the frame width. The vector field is printed only for small frames.   */
+{
+    PnmReader file_1, file_2;
+    MVector *mv;
+    int32 size;
+    long tcount;
+    float mean, min, max;
+    float noise_1, noise_2;
+    int filter_1, filter_2, error;
+
+    if (noise_of_file(name_1, &noise_1) || noise_of_file(name_2, &noise_2))
+    {
+        printf("\nError: cannot read the input images.\n");
+        return 1;
+    }
+    filter_1 = force_median || noise_1 > NOISE_RATIO;
+    filter_2 = force_median || noise_2 > NOISE_RATIO;
+    if (open_pnm_rows(name_1, &file_1))
+    {
+        printf("\nError: cannot open '%s'.\n", name_1);
+        return 1;
+    }
+    if (open_pnm_rows(name_2, &file_2))
+    {
+        printf("\nError: cannot open '%s'.\n", name_2);
+        close_pnm_rows(&file_1);
+        return 1;
+    }
+    if (file_1.width != file_2.width || file_1.height != file_2.height)
+    {
+        printf("\nError: Image sizes of the two frames do not match!\n");
+        close_pnm_rows(&file_1);
+        close_pnm_rows(&file_2);
+        return 1;
+    }
+    size = (file_2.width/MSTEP)*(file_2.height/MSTEP);
+    mv = get_memory("mv", sizeof(MVector)*size);
+    memset((char *) mv, 0, sizeof(MVector)*size);
+
+    XGpioPs_WritePin(&Gpio, LED, 0x1);
+    printf("\nBegin streaming motion estimation of %ldx%ld frames ...\n\n",
+           (long) file_2.width, (long) file_2.height);
+    tcount = get_usec_time();
+    error = file_search(mv, &file_1, &file_2, filter_1, filter_2);
+    tcount = get_usec_time() - tcount;
+    record_stage("file search", 2.0*file_2.width*file_2.height
+                 * (1 + filter_1 + filter_2), tcount);
+    XGpioPs_WritePin(&Gpio, LED, 0x0);
+    close_pnm_rows(&file_1);
+    close_pnm_rows(&file_2);
+    if (error)
+    {
+        printf("\nError: cannot read the input images.\n");
+        return 1;
+    }
+
+    compute_statistics(&mean, &min, &max, mv, size);
+    if (file_2.width <= 720 && file_2.height <= 576)
+    {
+        print_motion_vectors(mv, file_2.width/MSTEP, file_2.height/MSTEP);
+    }
+    printf("The motion vectors have a mean of %4.1f pixels.\n", mean);
+    printf("The motion vectors range between %4.1f and %4.1f pixels.\n", min, max);
+    printf("Frame 1 has %4.2f%% impulse noise, median3 filter %s.\n",
+           noise_1, filter_1? "applied" : "skipped");
+    printf("Frame 2 has %4.2f%% impulse noise, median3 filter %s.\n",
+           noise_2, filter_2? "applied" : "skipped");
+    printf("It took %ld milliseconds to read, filter and search the frames.\n",
+           tcount/1000);
+    report_memory();
+    report_telemetry();
+    arena_reset(&frame_arena);
+    return 0;
+}
+
+long prefilter_cost(const Prefilter *prefilter, CFrame *frame)
+/* Estimate how long the prefilter takes on the whole frame by filtering */
+/* a copy of its first CALIB_ROWS rows.                                  */
+{
+    uint8 *copy;
+    int   rows, border;
+    long  t;
+
+    border = 2*prefilter->radius;
+    rows = (frame->height < CALIB_ROWS + border)?
+           frame->height : CALIB_ROWS + border;
+    if (rows <= border)
+    {
+        return 0;
+    }
+    copy = get_memory("prefilter_cost", rows*frame->stride);
+    memcpy(copy, frame->pix, rows*frame->stride);
+    t = get_usec_time();
+    prefilter->run(copy, frame->width, rows, frame->stride);
+    t = get_usec_time() - t;
+    release_memory(copy);
+    return t * (frame->height - border) / (rows - border);
+}
+
+void benchmark_prefilters(CFrame *frame)
+/* Run every prefilter on a copy of the frame. The impulse noise left in */
+/* the filtered copy is printed as a rough measure of denoise quality.   */
+{
+    const Prefilter *p;
+    uint8 *copy;
+    int32 size = frame->height*frame->stride;
+    long  t;
+
+    copy = get_memory("benchmark_prefilters", size);
+    printf("\nPrefilter  time (ms)  impulses left  description\n");
+    for (p = prefilters; p->name != NULL; p++)
+    {
+        memcpy(copy, frame->pix, size);
+        t = get_usec_time();
+        p->run(copy, frame->width, frame->height, frame->stride);
+        t = get_usec_time() - t;
+        printf("%-9s  %9.2f  %12.2f%%  %s\n", p->name, t/1000.0f,
+               estimate_noise(copy, frame->width, frame->height, frame->stride),
+               p->description);
+    }
+    release_memory(copy);
+}
+
+/* Cache statistics of one benchmark run. The PMU and L2 event counters */
+/* are 32 bits wide; the L1D access count wraps on frames much larger    */
+/* than 720x480.                                                          */
+typedef struct
+{
+    long usec;
+    u32  l1_access, l1_refill;
+    u32  l2_request, l2_miss;
+} CacheStats;
+
+static void start_counters(CacheStats *stats)
+/* Start from clean caches so that both layouts load their data from DDR. */
+{
+    Xil_DCacheFlush();
+    XL2cc_EventCtrInit(XL2CC_DRREQ, XL2CC_DRHIT);
+    XL2cc_EventCtrStart();
+    Xpm_SetEvents(XPM_CNTRCFG1);
+    stats->usec = get_usec_time();
+}
+
+static void stop_counters(CacheStats *stats, const char *name)
+{
+    u32 pm[XPM_CTRCOUNT], hit;
+
+    stats->usec = get_usec_time() - stats->usec;
+    Xpm_GetEventCounters(pm);
+    XL2cc_EventCtrStop(&stats->l2_request, &hit);
+    stats->l1_access = pm[4], stats->l1_refill = pm[3];
+    stats->l2_miss = stats->l2_request - hit;
+    printf("%-22s  %9.2f  %12lu  %10lu  %10lu  %10lu\n", name,
+           stats->usec/1000.0f, (unsigned long) stats->l1_access,
+           (unsigned long) stats->l1_refill, (unsigned long) stats->l2_request,
+           (unsigned long) stats->l2_miss);
+}
+
+void benchmark_layouts(void)
+/* Read both frames in the row-major and in the tiled layout and count  */
+/* the L1 data cache refills and the L2 read misses of the 3x3 median   */
+/* filter of the two frames and of the full search on each layout, and  */
+/* of the strip search. The motion vectors of the two layouts and of    */
+/* the strip search must be identical.                                  */
+{
+    CFrame  r1, r2;
+    TFrame  t1, t2;
+    MVector *mv_r, *mv_s, *mv_t;
+    CacheStats stats;
+    int32   size, idx, diff;
+
+    if (read_pnm_frame("1.pgm", &r1, FRAME_PAD)
+        || read_pnm_frame("2.pgm", &r2, FRAME_PAD)
+        || read_pnm_tframe("1.pgm", &t1, FRAME_PAD)
+        || read_pnm_tframe("2.pgm", &t2, FRAME_PAD))
+    {
+        printf("benchmark_layouts: cannot read the frames.\n");
+        return;
+    }
+    size = (r1.width/MSTEP)*(r1.height/MSTEP);
+    mv_r = get_memory("benchmark_layouts", size*sizeof(MVector));
+    mv_s = get_memory("benchmark_layouts", size*sizeof(MVector));
+    mv_t = get_memory("benchmark_layouts", size*sizeof(MVector));
+
+    printf("\nKernel, layout           time (ms)    L1D access  L1D refill"
+           "     L2 read     L2 miss\n");
+    start_counters(&stats);
+    median3x3(r1.pix, r1.width, r1.height, r1.stride);
+    median3x3(r2.pix, r2.width, r2.height, r2.stride);
+    pad_frame(&r1);
+    pad_frame(&r2);
+    stop_counters(&stats, "median3x3, row-major");
+    start_counters(&stats);
+    median3x3_tiled(&t1);
+    median3x3_tiled(&t2);
+    stop_counters(&stats, "median3x3, tiled");
+    start_counters(&stats);
+    full_search(mv_r, &r1, &r2);
+    stop_counters(&stats, "full_search, row-major");
+    start_counters(&stats);
+    (void) strip_search(mv_s, &r1, &r2);
+    stop_counters(&stats, "strip_search");
+    start_counters(&stats);
+    full_search_tiled(mv_t, &t1, &t2);
+    stop_counters(&stats, "full_search, tiled");
+
+    for (idx = diff = 0; idx < size; idx++)
+    {
+        diff += mv_r[idx].x != mv_t[idx].x || mv_r[idx].y != mv_t[idx].y;
     }
+    printf("%ld of %ld motion vectors differ between the layouts.\n",
+           diff, size);
+    for (idx = diff = 0; idx < size; idx++)
+    {
+        diff += mv_r[idx].x != mv_s[idx].x || mv_r[idx].y != mv_s[idx].y;
+    }
+    printf("%ld of %ld motion vectors differ between full_search and "
+           "strip_search.\n", diff, size);
+
+    release_memory(mv_r);
+    free_frame(&r1);
+    free_frame(&r2);
+    free_tframe(&t1);
+    free_tframe(&t2);
 }
 
-int32 compute_sad(uint8 *prev, uint8 *curr, int width, int px, int py, int cx, int cy)
+void benchmark_ocm(CFrame *frame_1, CFrame *frame_2, MVector *mv)
+/* Time strip_search() with its windows in the DDR and in the OCM. */
 {
-    int x, y;
-    int sad = 0;
+    long t;
+    int  saved = ocm_scratch;
 
-    for (y = 0; y < BSIZE; y++)
+#ifdef OCM_KERNELS
+    printf("\nThe SAD and median kernels run from the OCM.");
+#endif
+    printf("\nWindows  time (ms)\n");
+    for (ocm_scratch = 0; ocm_scratch <= 1; ocm_scratch++)
+    {
+        t = get_usec_time();
+        (void) strip_search(mv, frame_1, frame_2);
+        t = get_usec_time() - t;
+        printf("%-7s  %9.2f\n", ocm_scratch? "OCM" : "DDR", t/1000.0f);
+    }
+    ocm_scratch = saved;
+}
+
+static void echo_messages(void *arg, int first, int end)
+/* CPU1 side of the round trips: send the messages back. */
+{
+    Message msg;
+    int i;
+
+    if (*(int *) arg)
+    {
+        mailbox_doorbell(ping, 0);
+    }
+    for (i = first; i < end; i++)
     {
-        for (x = 0; x < BSIZE; x++)
+        mailbox_receive_wait(ping, &msg);
+        mailbox_send_wait(pong, &msg);
+    }
+}
+
+static void sink_messages(void *arg, int first, int end)
+/* CPU1 side of the throughput test: add up the messages. */
+{
+    Message msg;
+    int i;
+
+    for (i = first; i < end; i++)
+    {
+        mailbox_receive_wait(ping, &msg);
+        *(uint32 *) arg += msg.arg[0];
+    }
+}
+
+void benchmark_mailbox(void)
+/* Time MAILBOX_ROUNDS round trips of a message through CPU1, and as */
+/* many messages streamed to CPU1.                                    */
+{
+    Message msg;
+    uint32  sum = 0, expected = 0;
+    long    t;
+    int     i, doorbell;
+
+    if (amp_cores < 2)
+    {
+        printf("\nThe mailbox benchmark needs CPU1.\n");
+        return;
+    }
+    memset(&msg, 0, sizeof(msg));
+    printf("\nWake-up  round trip (us)\n");
+    for (doorbell = 0; doorbell <= 1; doorbell++)
+    {
+        if (doorbell)
+        {
+            mailbox_doorbell(pong, 1);
+        }
+        amp_post(echo_messages, &doorbell, 0, MAILBOX_ROUNDS);
+        t = get_usec_time();
+        for (i = 0; i < MAILBOX_ROUNDS; i++)
         {
-            /* compute the sum of absolute difference */
-            sad += abs(prev[(py+y)*width+(px+x)] - curr[(cy+y)*width+(cx+x)]);
+            msg.arg[0] = i;
+            mailbox_send_wait(ping, &msg);
+            mailbox_receive_wait(pong, &msg);
         }
+        t = get_usec_time() - t;
+        amp_wait();
+        printf("%-7s  %15.3f\n", doorbell? "SGI" : "WFE",
+               (float) t/MAILBOX_ROUNDS);
     }
-    return sad;
+
+    amp_post(sink_messages, &sum, 0, MAILBOX_ROUNDS);
+    t = get_usec_time();
+    for (i = 0; i < MAILBOX_ROUNDS; i++)
+    {
+        msg.arg[0] = i;
+        expected += i;
+        mailbox_send_wait(ping, &msg);
+    }
+    amp_wait();
+    t = get_usec_time() - t;
+    printf("Streamed %d messages in %ld ms, %.2f million/s%s.\n",
+           MAILBOX_ROUNDS, t/1000, (float) MAILBOX_ROUNDS/t,
+           (sum == expected)? "" : ", with LOST MESSAGES");
 }
 
-int match(int *x, int *y, int posx, int posy, uint8 *prev, uint8 *curr, int width)
-/* Try to find the best match of the 16x16 block located at (idx, idy) of    */
-/* the current image in the search window of the previous image. The search  */
-/* window is defined as a 32x32 area in the previous image at the location   */
-/* centered around the block position (idx, idy).                            */
-/* The motion vector of both x and y components range from -16 to 15 pixels. */
+typedef struct
 {
-    int min_sad, sad, mvx, mvy;
+    const char *name;
+    uint8      *buf;
+    int        passes;
+    int        sgi;          /* doorbell of CPU1, or -1                   */
+    long       bytes;        /* read, or -1 on error                      */
+} FileJob;
 
-    /* Set the matching error to the largest integer value */
-    min_sad = INT_MAX;
-    for (mvy = -BSIZE; mvy < BSIZE; mvy++)
+static long read_file(const char *name, uint8 *buf, int passes)
+/* Read a file passes times in chunks of FSLOCK_CHUNK bytes. Returns */
+/* the number of bytes read, or -1 on error.                         */
+{
+    FIL  fobj;
+    UINT nbytes;
+    long bytes = 0;
+    int  i;
+
+    for (i = 0; i < passes; i++)
     {
-        for (mvx = -BSIZE; mvx < BSIZE; mvx++)
+        if (f_open(&fobj, name, FA_READ))
         {
-            /* Trying to compute the matching cost at (posx, posy) */
-            sad = compute_sad(prev, curr, width, posx+mvx, posy+mvy, posx, posy);
-
-            /* If the matching cost is minimal, record it */
-            if (sad <= min_sad)
+            return -1;
+        }
+        do
+        {
+            if (f_read(&fobj, buf, FSLOCK_CHUNK, &nbytes))
             {
-                min_sad = sad;
-                *x = mvx, *y = mvy;
+                f_close(&fobj);
+                return -1;
             }
+            bytes += nbytes;
+        } while (nbytes == FSLOCK_CHUNK);
+        f_close(&fobj);
+    }
+    return bytes;
+}
+
+static long write_file(const char *name, uint8 *buf, long size)
+/* Write size bytes to a file in chunks of FSLOCK_CHUNK bytes. Returns */
+/* the number of bytes written, or -1 on error.                        */
+{
+    FIL  fobj;
+    UINT nbytes;
+    long bytes;
+
+    if (f_open(&fobj, name, FA_CREATE_ALWAYS | FA_WRITE))
+    {
+        return -1;
+    }
+    for (bytes = 0; bytes < size; bytes += nbytes)
+    {
+        if (f_write(&fobj, buf, FSLOCK_CHUNK, &nbytes) || nbytes == 0)
+        {
+            f_close(&fobj);
+            return -1;
         }
     }
-    return min_sad;
+    f_close(&fobj);
+    return bytes;
 }
 
-void full_search(MVector *mv, uint8 *prev_image, uint8 *curr_image, int32 width, int32 height)
-/* Use full-search algorithm to find the motion vectors of the second */
-/* image (curr_image) w.r.t. the first image (prev_image).            */
+static void read_job(void *arg, int first, int end)
+/* CPU1 side of the contended run: read the file. */
 {
-    int idx, idy, nx, ny;
-    int x, y;
+    FileJob *job = arg;
+
+    if (job->sgi >= 0)
+    {
+        fslock_doorbell(job->sgi);
+    }
+    job->bytes = read_file(job->name, job->buf, job->passes);
+}
 
-    /* Compute the number of movtion vectors per frame. */
-    nx = width/MSTEP, ny = height/MSTEP;
+static float mb_rate(long bytes, long usec)
+/* Bytes per microsecond, 0 if the transfer failed. */
+{
+    return (bytes > 0)? (float) bytes/(usec > 0? usec : 1) : 0;
+}
 
-    /* Although we declare mv[] as an 1D array, it is actually used as a 2D */
-    /* array in row-major arrangement.  The width and height of mv[] are nx */
-    /* and ny. For example, if the image size is 720x480, there are 45x30   */
-    /* motion vectors.                                                      */
+void benchmark_fslock(void)
+/* Time FSLOCK_ROUNDS grants of the volume lock without contention,   */
+/* then the file transfers of CPU0 alone and against CPU1.           */
+{
+    FileJob job;
+    uint8   *wbuf;
+    long    t, tread, written;
+    int     doorbell, i;
 
-    /* Looping through the computation of the (nx-2)*(ny-2) motion vectors. */
-    /* Note that we exclude the estimation of the vectors at the boundary   */
-    /* positions to keep it simple. The boundary vectors are set to zero.   */
-    for (idy = 2; idy < ny-4; idy++)
+    printf("\nFatFs volume lock\n");
+    t = get_usec_time();
+    for (i = 0; i < FSLOCK_ROUNDS; i++)
     {
-        for (idx = 2; idx < nx-4; idx++)
-        {
-            /* Find the best match of the current block in the previous frame. */
-            (void) match(&x, &y, (idx*MSTEP), (idy*MSTEP), prev_image, curr_image, width);
+        ff_req_grant(fatfs.sobj);
+        ff_rel_grant(fatfs.sobj);
+    }
+    t = get_usec_time() - t;
+    printf("Grant and release without contention: %.1f ns.\n",
+           t*1000.0f/FSLOCK_ROUNDS);
+    clear_fslocks();
 
-            /* Store the motion vector at the current position. */
-            mv[idy*nx+idx].x = x, mv[idy*nx+idx].y = y;
-        }
+    job.name = "1.pgm";
+    job.buf = pool_get("fslock read", FSLOCK_CHUNK);
+    job.passes = FSLOCK_PASSES;
+    job.sgi = -1;
+    wbuf = pool_get("fslock write", FSLOCK_CHUNK);
+    memset(wbuf, 0x5A, FSLOCK_CHUNK);
+
+    /* Alone, CPU0 reads and then writes; together, CPU1 reads while */
+    /* CPU0 writes.                                                  */
+    printf("\n            read (MB/s)  write (MB/s)\n");
+    tread = get_usec_time();
+    job.bytes = read_file(job.name, job.buf, job.passes);
+    tread = get_usec_time() - tread;
+    t = get_usec_time();
+    written = write_file("fslock.bin", wbuf, FSLOCK_BYTES);
+    t = get_usec_time() - t;
+    printf("%-10s  %11.2f  %12.2f\n", "alone", mb_rate(job.bytes, tread),
+           mb_rate(written, t));
+
+    for (doorbell = 0; doorbell <= 1 && amp_cores == 2; doorbell++)
+    {
+        job.sgi = doorbell? 2 : -1;
+        amp_post(read_job, &job, 0, 1);
+        t = get_usec_time();
+        written = write_file("fslock.bin", wbuf, FSLOCK_BYTES);
+        t = get_usec_time() - t;
+        amp_wait();
+        printf("%-10s  %11.2f  %12.2f\n", doorbell? "both, SGI" : "both, WFE",
+               mb_rate(job.bytes, amp_cpu1_usec()), mb_rate(written, t));
+    }
+    if (amp_cores < 2)
+    {
+        printf("The contended runs need CPU1.\n");
     }
+    report_fslocks();
+    f_unlink("fslock.bin");
+    pool_put(wbuf, FSLOCK_CHUNK);
+    pool_put(job.buf, FSLOCK_CHUNK);
 }
 
 void  print_motion_vectors(MVector *mv, int w, int h)
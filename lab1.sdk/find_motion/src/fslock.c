@@ -0,0 +1,224 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : fslock.c                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The FatFs sync objects of fslock.h.                                    */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include "fslock.h"
+#include "ocm.h"
+#include "amp.h"
+#include "task.h"
+#include "ff.h"
+
+/* Largest number of volumes. */
+#define FSLOCK_VOLUMES 4
+
+long get_usec_time();
+
+static FsLock *locks[FSLOCK_VOLUMES];
+
+#ifndef HOST_BUILD
+#include "gic.h"
+#include "xpseudo_asm.h"
+
+#define sev() __asm__ __volatile__("sev" : : : "memory")
+#define wfe() __asm__ __volatile__("wfe" : : : "memory")
+
+/* Doorbell SGI of each core, or -1 to wait in WFE. */
+static int doorbells[2] = { -1, -1 };
+
+static void wake(FsLock *lock, int cpu)
+/* Wake the other core if it waits for the lock. */
+{
+    int other = 1 - cpu;
+
+    dsb();
+    if (__atomic_load_n(&lock->waiting[other], __ATOMIC_RELAXED)
+        && doorbells[other] >= 0)
+    {
+        gic_ring(other, doorbells[other]);
+    }
+    sev();
+}
+
+static int held_here(uint32 owner, int cpu)
+/* Whether the lock is held by a task of this core. */
+{
+    return owner == (uint32) cpu + 1;
+}
+
+static void doze(FsLock *lock, int cpu, uint32 owner)
+/* Wait for a wake() of the other core, unless the lock has changed     */
+/* hands since it was found held by owner (see gic_wait()).             */
+{
+    if (doorbells[cpu] < 0)
+    {
+        wfe();
+        return;
+    }
+    gic_wait((volatile uint32 *) &lock->owner, owner);
+}
+#else
+#include <sched.h>
+
+static void wake(FsLock *lock, int cpu)
+{
+}
+
+static int held_here(uint32 owner, int cpu)
+{
+    return 0;
+}
+
+static void doze(FsLock *lock, int cpu, uint32 owner)
+{
+    sched_yield();
+}
+#endif
+
+int fslock_doorbell(int sgi)
+/* Called by a core: wait for the locks in WFI, woken by SGI sgi        */
+/* (0 .. 15), instead of in WFE. Returns 1 if sgi is not an SGI or the  */
+/* interrupt controller is not initialized.                             */
+{
+    if (sgi < 0 || sgi > 15)
+    {
+        return 1;
+    }
+#ifndef HOST_BUILD
+    if (gic_doorbell(sgi))
+    {
+        return 1;
+    }
+    doorbells[amp_cpu_id()] = sgi;
+#endif
+    return 0;
+}
+
+int ff_cre_syncobj(BYTE vol, _SYNC_t *sobj)
+/* Called by f_mount(): the lock of volume vol, in the OCM. A volume    */
+/* mounted again keeps its lock. Returns 0 on failure.                  */
+{
+    if (vol >= FSLOCK_VOLUMES)
+    {
+        return 0;
+    }
+    if (locks[vol] == NULL)
+    {
+        ocm_share();
+        locks[vol] = ocm_alloc("fatfs lock", sizeof(FsLock));
+        if (locks[vol] == NULL)
+        {
+            return 0;
+        }
+        memset(locks[vol], 0, sizeof(FsLock));
+        locks[vol]->vol = vol;
+    }
+    *sobj = locks[vol];
+    return 1;
+}
+
+int ff_del_syncobj(_SYNC_t sobj)
+/* Called by f_mount() when the volume is unmounted. The lock stays in */
+/* the OCM for the next mount.                                          */
+{
+    return 1;
+}
+
+int ff_req_grant(_SYNC_t lock)
+/* Take the lock of a volume. Returns 0 after _FS_TIMEOUT ms. */
+{
+    int    cpu = amp_cpu_id();
+    uint32 free = 0, owner;
+    long   t, wait;
+
+    if (__atomic_compare_exchange_n(&lock->owner, &free, cpu + 1, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        lock->count++;
+        return 1;
+    }
+
+    t = get_usec_time();
+    __atomic_store_n(&lock->waiting[cpu], 1, __ATOMIC_SEQ_CST);
+    for (;;)
+    {
+        free = 0;
+        if (__atomic_compare_exchange_n(&lock->owner, &free, cpu + 1, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+        if (get_usec_time() - t > _FS_TIMEOUT*1000L)
+        {
+            __atomic_store_n(&lock->waiting[cpu], 0, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&lock->timeouts, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+        /* Let the other tasks run, the owner among them if it is on  */
+        /* this core; with no other task, wait for the other core.     */
+        owner = free;
+        if (!task_yield() && !held_here(owner, cpu))
+        {
+            doze(lock, cpu, owner);
+        }
+    }
+    __atomic_store_n(&lock->waiting[cpu], 0, __ATOMIC_RELAXED);
+
+    wait = get_usec_time() - t;
+    lock->count++;
+    lock->contended++;
+    lock->wait_usec += wait;
+    if (wait > lock->max_usec)
+    {
+        lock->max_usec = wait;
+    }
+    return 1;
+}
+
+void ff_rel_grant(_SYNC_t lock)
+/* Release the lock of a volume and wake the other core. */
+{
+    int cpu = amp_cpu_id();
+
+    __atomic_store_n(&lock->owner, 0, __ATOMIC_RELEASE);
+    wake(lock, cpu);
+}
+
+void report_fslocks(void)
+/* Print the grants of the volume locks. */
+{
+    FsLock *lock;
+    int    i;
+
+    printf("\nVolume  grants  contended  timeouts  wait (ms)  max (us)\n");
+    for (i = 0; i < FSLOCK_VOLUMES; i++)
+    {
+        if ((lock = locks[i]) == NULL)
+        {
+            continue;
+        }
+        printf("%6d  %6lu  %9lu  %8lu  %9.1f  %8ld\n", lock->vol,
+               (unsigned long) lock->count, (unsigned long) lock->contended,
+               (unsigned long) lock->timeouts, lock->wait_usec/1000.0,
+               lock->max_usec);
+    }
+}
+
+void clear_fslocks(void)
+/* Reset the counts of the volume locks. */
+{
+    FsLock *lock;
+    int    i;
+
+    for (i = 0; i < FSLOCK_VOLUMES; i++)
+    {
+        if ((lock = locks[i]) != NULL)
+        {
+            lock->count = lock->contended = lock->timeouts = 0;
+            lock->wait_usec = lock->max_usec = 0;
+        }
+    }
+}
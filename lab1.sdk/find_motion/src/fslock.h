@@ -0,0 +1,51 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : fslock.h                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The sync objects of FatFs, which is built reentrant (_FS_REENTRANT in */
+/*  ffconf.h of the BSP) so that both cores and the tasks of a core can   */
+/*  use the files of a volume at the same time. FatFs takes the lock of   */
+/*  the volume for the whole of every f_read(), f_write(), f_open(), ...  */
+/*  call, through ff_req_grant() and ff_rel_grant().                      */
+/*                                                                         */
+/*  The lock of a volume is a spinlock in the shareable OCM holding the   */
+/*  core of its owner plus one, taken with an exclusive compare-and-swap. */
+/*  A core that finds it taken by a task of its own lets the other tasks */
+/*  run (task.h); one that finds it taken by the other core waits in WFE, */
+/*  or in WFI for an SGI once it has called fslock_doorbell() (see        */
+/*  gic_wait() in gic.h), and is woken by the release. A grant that       */
+/*  waits more than _FS_TIMEOUT ms fails and the FatFs call returns       */
+/*  FR_TIMEOUT. On the host (HOST_BUILD) every thread counts as core 0    */
+/*  and the waits yield the thread.                                       */
+/*                                                                         */
+/*  The FATFS and FIL objects themselves are plain data, so they must be  */
+/*  in memory both cores see coherently: the DDR and the OCM sections of */
+/*  the BSP are shareable (see region.h).                                  */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __FSLOCK_H__
+
+#include "image.h"
+
+/* Size of the cache lines of the A9. */
+#define FSLOCK_LINE 32
+
+typedef struct FsLock
+{
+    uint32  owner;          /* core of the owner + 1, or 0 if free         */
+    uint8   pad[FSLOCK_LINE - sizeof(uint32)];
+    uint32  waiting[2];     /* set by a core while it waits                */
+    int     vol;            /* the volume                                  */
+    uint32  count;          /* grants                                      */
+    uint32  contended;      /* grants that had to wait                     */
+    uint32  timeouts;       /* grants that failed                          */
+    long    wait_usec;      /* total time waited for the grants            */
+    long    max_usec;       /* longest wait                                */
+} FsLock;
+
+int  fslock_doorbell(int sgi);
+void report_fslocks(void);
+void clear_fslocks(void);
+
+#define __FSLOCK_H__
+#endif
@@ -0,0 +1,108 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : gic.c                                                         */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The shared interrupt controller of gic.h.                              */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "gic.h"
+#include "amp.h"
+
+#ifndef HOST_BUILD
+#include "xparameters.h"
+#include "xil_exception.h"
+#include "xpseudo_asm.h"
+
+#define wfi() __asm__ __volatile__("wfi" : : : "memory")
+
+XScuGic gic;
+
+/* Cores whose CPU interface is enabled. */
+static volatile int cpu_ready[2];
+
+int gic_init(void)
+/* Initialize the controller and route the IRQ exception of this core */
+/* to its handler. Only the first call does anything. Returns 0 on    */
+/* success.                                                            */
+{
+    XScuGic_Config *cfg;
+
+    if (gic.IsReady == XIL_COMPONENT_IS_READY)
+    {
+        return 0;
+    }
+    cfg = XScuGic_LookupConfig(XPAR_SCUGIC_SINGLE_DEVICE_ID);
+    if (cfg == NULL || XScuGic_CfgInitialize(&gic, cfg, cfg->CpuBaseAddress))
+    {
+        printf("gic_init: cannot initialize the interrupt controller.\n");
+        return 1;
+    }
+    Xil_ExceptionInit();
+    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT,
+        (Xil_ExceptionHandler) XScuGic_InterruptHandler, &gic);
+    Xil_ExceptionEnable();
+    cpu_ready[amp_cpu_id()] = 1;
+    return 0;
+}
+
+static void doorbell_handler(void *arg)
+/* The doorbells only wake the core. */
+{
+}
+
+int gic_doorbell(int sgi)
+/* Let the calling core be woken from gic_wait() by SGI sgi (0 .. 15). */
+/* The CPU interface of CPU1, which gic_init() did not set up, is       */
+/* enabled as XScuGic_CfgInitialize() does it for CPU0. Returns 1 if   */
+/* sgi is not an SGI or the controller is not initialized.             */
+{
+    int cpu = amp_cpu_id();
+
+    if (sgi < 0 || sgi > 15 || gic.IsReady != XIL_COMPONENT_IS_READY)
+    {
+        return 1;
+    }
+    if (!cpu_ready[cpu])
+    {
+        XScuGic_CPUWriteReg(&gic, XSCUGIC_CPU_PRIOR_OFFSET, 0xF0);
+        XScuGic_CPUWriteReg(&gic, XSCUGIC_CONTROL_OFFSET, 0x07);
+        cpu_ready[cpu] = 1;
+    }
+    XScuGic_Connect(&gic, sgi, doorbell_handler, NULL);
+
+    /* The enable bits of the SGIs are banked: this enables it for the */
+    /* calling core only.                                              */
+    XScuGic_Enable(&gic, sgi);
+    return 0;
+}
+
+void gic_ring(int cpu, int sgi)
+/* Send SGI sgi to core cpu. */
+{
+    XScuGic_SoftwareIntr(&gic, sgi, 1 << cpu);
+}
+
+void gic_wait(volatile uint32 *word, uint32 value)
+/* Wait for an interrupt unless *word no longer holds value. The IRQs  */
+/* are masked from the check to the dispatch, see gic.h.               */
+{
+    uint32 cpsr = mfcpsr();
+
+    mtcpsr(cpsr | XREG_CPSR_IRQ_ENABLE);
+    dmb();
+    if (*word == value)
+    {
+        wfi();
+        XScuGic_InterruptHandler(&gic);
+    }
+    mtcpsr(cpsr);
+}
+
+#else
+
+int gic_init(void)
+{
+    return 0;
+}
+
+#endif
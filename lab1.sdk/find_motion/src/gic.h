@@ -0,0 +1,47 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : gic.h                                                         */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The generic interrupt controller (GIC) of the A9 cores. There is one   */
+/*  distributor for both cores, so there is one XScuGic instance, gic,    */
+/*  initialized once by CPU0 from main() with gic_init() before CPU1 is   */
+/*  started and before any module connects a handler. Initializing the    */
+/*  controller again would reset the distributor, disabling the           */
+/*  interrupts and SGI doorbells set up before, and would replace the     */
+/*  IRQ vector. The modules only connect and enable their interrupts.     */
+/*                                                                         */
+/*  The doorbells of the mailboxes (mailbox.h) and of the volume locks    */
+/*  (fslock.h) wake a core from WFI with a software generated interrupt  */
+/*  (SGI). A core that wants to be woken connects a handler that does     */
+/*  nothing to its SGI with gic_doorbell(), and waits with gic_wait(),    */
+/*  which keeps the IRQs masked from its last check to the WFI so that    */
+/*  an SGI sent in between stays pending and ends the WFI at once. The    */
+/*  interrupt that ended the WFI is then acknowledged and dispatched by   */
+/*  XScuGic_InterruptHandler(), whatever it is, still with the IRQs       */
+/*  masked: CPU1 has no IRQ stack, and a handler of another interrupt,   */
+/*  such as the DMA of prefetch.c, still runs and completes it.           */
+/*                                                                         */
+/*  On the host (HOST_BUILD) there is no controller and gic_init() does   */
+/*  nothing.                                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __GIC_H__
+
+#include "image.h"
+
+#ifndef HOST_BUILD
+#include "xscugic.h"
+
+extern XScuGic gic;
+#endif
+
+int gic_init(void);
+
+#ifndef HOST_BUILD
+int  gic_doorbell(int sgi);
+void gic_ring(int cpu, int sgi);
+void gic_wait(volatile uint32 *word, uint32 value);
+#endif
+
+#define __GIC_H__
+#endif
@@ -6,170 +6,590 @@
 /*	This is an image I/O library for Portable Any Map (PNM) images.     */
 /* //////////////////////////////////////////////////////////////////// */
 
+#include <ctype.h>
 #include "xparameters.h"  /* SDK generated parameters */
 #include "xsdps.h"        /* for SD device driver     */
 #include "ff.h"
 #include "image.h"
+#include "arena.h"
 
 void *get_memory(char *name, int32 size)
+/* Allocate from the frame arena; see arena.h. The block stays valid */
+/* until it, or a block allocated before it, is released.            */
 {
-    void *p;
+    return arena_alloc(&frame_arena, name, size, FRAME_ALIGN);
+}
+
+void release_memory(void *p)
+/* Free the block p of get_memory() and every block allocated after it. */
+{
+    arena_release(&frame_arena, (uint32) ((uint8 *) p - frame_arena.base));
+}
+
+/* The header of a PNM file is parsed from its first sector, which is  */
+/* read whole; the pixels that follow it in the sector are copied out  */
+/* and the rest of the file is then on a sector boundary, where f_read() */
+/* and f_write() transfer straight between the card and the buffer.    */
+#define PNM_SECTOR 512
+
+static int parse_pnm_number(const uint8 *buf, int size, int *pos)
+/* Skip the white space and comments at *pos and read a decimal number. */
+/* Returns -1 if there is none.                                        */
+{
+    int n = *pos, value = 0;
+
+    while (n < size && (isspace(buf[n]) || buf[n] == '#'))
+    {
+        if (buf[n] == '#')
+        {
+            while (n < size && buf[n] != '\n')
+            {
+                n++;
+            }
+        }
+        else
+        {
+            n++;
+        }
+    }
+    if (n == size || !isdigit(buf[n]))
+    {
+        return -1;
+    }
+    while (n < size && isdigit(buf[n]) && value < 65536)
+    {
+        value = value*10 + buf[n++] - '0';
+    }
+    *pos = n;
+    return value;
+}
+
+static int parse_pnm_header(const uint8 *buf, int size, CImage *image)
+/* Parse the PNM header at the start of buf. Returns its length, or 0 if */
+/* the file is not a PGM or PPM file with 8-bit samples or its header   */
+/* does not end within buf.                                             */
+{
+    int pos = 2, max_level;
+
+    if (size < 2 || buf[0] != 'P' || (buf[1] != '5' && buf[1] != '6'))
+    {
+        return 0;
+    }
+    image->depth = (buf[1] == '5')? 8 : 24;
+    image->width = parse_pnm_number(buf, size, &pos);
+    image->height = parse_pnm_number(buf, size, &pos);
+    max_level = parse_pnm_number(buf, size, &pos);
+    if (image->width <= 0 || image->height <= 0 || max_level <= 0
+        || max_level > 255 || pos == size || !isspace(buf[pos]))
+    {
+        return 0;
+    }
+    return pos + 1;
+}
 
-    if ((p = malloc(size)) == NULL)
+static int read_pnm_sector(FIL *fobj, CImage *image, uint8 *sector,
+                           unsigned int *nbytes)
+/* Read the first sector of a PNM file into sector, cache-line aligned, */
+/* and parse the header. Returns the length of the header, 0 on error.  */
+{
+    if (f_read(fobj, (void *) sector, PNM_SECTOR, nbytes))
     {
-        printf("get_memory: No memory for '%s'!\n", name);
-        exit(1);
+        return 0;
     }
-    return p;
+    return parse_pnm_header(sector, *nbytes, image);
+}
+
+static int read_pnm_header(FIL *fobj, CImage *image)
+/* Read the PNM header and leave the file at the first pixel. Returns 1 */
+/* if the file is not a PGM or PPM file with 8-bit samples.             */
+{
+    uint8 sector[PNM_SECTOR] __attribute__((aligned(FRAME_ALIGN)));
+    unsigned int nbytes;
+    int header;
+
+    header = read_pnm_sector(fobj, image, sector, &nbytes);
+    return header == 0 || f_lseek(fobj, header);
 }
 
 int read_pnm_image(const char *filename, CImage *image)
+/* Read a PGM or PPM image into memory from get_memory(). The pixels    */
+/* after the first sector are read in one request, into a cache-aligned */
+/* part of the block.                                                   */
 {
 	static FIL fobj;
-    char buf[32];
-    uint8 *ptr;
-    unsigned int nbytes;
-    int n, idx, max_level = 256, image_line;
+    uint8 sector[PNM_SECTOR] __attribute__((aligned(FRAME_ALIGN)));
+    unsigned int nbytes, first, size;
+    int header;
 
 	if (f_open(&fobj, filename, FA_READ))
 	{
         printf("read_pnm_image: cannot open '%s'.\n", filename);
 		return 1;
 	}
+    if ((header = read_pnm_sector(&fobj, image, sector, &nbytes)) == 0)
+    {
+        printf("read_pnm_image: unsupported image file.\n");
+        f_close(&fobj);
+        return 1;
+    }
+
+    /* The pixels start header bytes into the file, so starting them   */
+    /* header bytes into an aligned line puts the sector boundaries on */
+    /* aligned addresses.                                              */
+    size = (unsigned int) image->width*image->height*(image->depth/8);
+    first = nbytes - header;
+    first = (first < size)? first : size;
+    image->pix = (uint8 *) get_memory("image->pix", size + FRAME_ALIGN)
+                 + (header & (FRAME_ALIGN-1));
+    memcpy(image->pix, sector + header, first);
+    nbytes = 0;
+    if (first < size)
+    {
+        f_read(&fobj, (void *) (image->pix + first), size - first, &nbytes);
+    }
+    f_close(&fobj);
+    if (first + nbytes != size)
+    {
+        printf("read_pnm_image: image read error.\n");
+        return 1;
+    }
+    return 0;
+}
+
+int write_pnm_image(const char *filename, CImage *image)
+/* Write a PGM or PPM image. The header and the first pixels fill the  */
+/* first sector, the rest of the pixels are written in one request.   */
+{
+	static FIL fobj;
+    uint8 sector[PNM_SECTOR] __attribute__((aligned(FRAME_ALIGN)));
+    unsigned int nbytes, first, size;
+    int header;
 
-    /* read PGM headers */
-	if (f_read(&fobj, (void *) buf, 2, &nbytes))
+    if (image->depth != 8 && image->depth != 24)
+    {
+        printf("write_pnm_image: unsupported image depth.\n");
+        return 1;
+    }
+
+	if (f_open(&fobj, filename, FA_CREATE_ALWAYS | FA_WRITE))
 	{
+        printf("write_pnm_image: cannot open '%s'.\n", filename);
 		return 1;
 	}
-    buf[2] = '\0';
-    if (!strncmp(buf, "P5", 2))
+
+    /* write the header, the max level and the first pixels */
+    header = snprintf((char *) sector, sizeof(sector), "%s\n%ld %ld\n255\n",
+                      (image->depth == 8)? "P5" : "P6",
+                      (long) image->width, (long) image->height);
+    size = (unsigned int) image->width*image->height*(image->depth/8);
+    first = PNM_SECTOR - header;
+    first = (first < size)? first : size;
+    memcpy(sector + header, image->pix, first);
+    f_write(&fobj, (void *) sector, header + first, &nbytes);
+    if (nbytes != header + first)
     {
-        image->depth = 8;
+        printf("write_pnm_image: Error writing PGM header.\n");
+        f_close(&fobj);
+        return 1;
     }
-    else if (!strncmp(buf, "P6", 2))
+
+    /* write the rest of the image */
+    nbytes = 0;
+    if (first < size)
     {
-        image->depth = 24;
+        f_write(&fobj, (void *) (image->pix + first), size - first, &nbytes);
     }
-    else
+    f_close(&fobj);
+    if (first + nbytes != size)
     {
-        printf("read_pnm_image: unsupported image file.\n");
+        printf("write_pnm_image: image write error.\n");
         return 1;
     }
+    return 0;
+}
+
+uint32 frame_bytes(int32 width, int32 height, int32 pad)
+/* Size of the pool buffer of a frame from alloc_frame(). */
+{
+    int32 stride;
+
+    pad = (pad + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    stride = (width + 2*pad + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    return (uint32) stride*(height + 2*pad);
+}
+
+void alloc_frame(CFrame *frame, int32 width, int32 height, int32 pad)
+/* Allocate a frame with a border of at least pad pixels from the frame  */
+/* buffer pools. The border is rounded up to FRAME_ALIGN so that every   */
+/* row start is aligned.                                                 */
+{
+    pad = (pad + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    frame->width = width, frame->height = height;
+    frame->pad = pad;
+    frame->stride = (width + 2*pad + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    frame->mem = pool_get("frame->mem", frame_bytes(width, height, pad));
+    frame->pix = frame->mem + pad*frame->stride + pad;
+}
+
+void free_frame(CFrame *frame)
+/* Return the buffer of the frame to its pool. */
+{
+    pool_put(frame->mem, frame->stride*(frame->height + 2*frame->pad));
+    frame->mem = frame->pix = NULL;
+}
 
-    /* read width, height, and max level */
-    for (idx = 0; idx < 4; idx++)
+void pad_frame(CFrame *frame)
+/* Fill the border of the frame by replicating the outermost pixels. */
+{
+    uint8 *row;
+    int32 y, pad = frame->pad, width = frame->width;
+
+    for (y = 0; y < frame->height; y++)
     {
-        n = 0;
-        do
-        {
-        	f_read(&fobj, (void *) buf+n, 1, &nbytes);
-        	if (nbytes == 1)
-        	{
-                if (buf[n] == 0x0a || buf[n] == ' ' ||
-                    buf[n] == 0x0d || buf[n] == 0x09)
-                {
-                    buf[n] = '\0';
-                    switch (idx)
-                    {
-                    case 0: /* skip trailing white space to "P5" */
-                        break;
-                    case 1: /* save width */
-                        image->width = atoi(buf);
-                        break;
-                    case 2: /* save height */
-                        image->height = atoi(buf);
-                        break;
-                    case 3: /* save max level */
-                        max_level = atoi(buf);
-                        break;
-                    }
-                    n = 0;
-                    break;
-                }
-                else
-                {
-                    n++;
-                }
-            }
-        } while (nbytes == 1);
+        row = frame->pix + y*frame->stride;
+        memset(row-pad, row[0], pad);
+        memset(row+width, row[width-1], frame->stride-width-pad);
     }
+    row = frame->pix - pad;
+    for (y = 1; y <= pad; y++)
+    {
+        memcpy(row - y*frame->stride, row, frame->stride);
+        memcpy(row + (frame->height-1+y)*frame->stride,
+               row + (frame->height-1)*frame->stride, frame->stride);
+    }
+}
 
-    if (max_level > 255)
+int read_pnm_frame(const char *filename, CFrame *frame, int32 pad)
+/* Read an 8-bit PGM image into a newly allocated frame with a border of */
+/* at least pad pixels. The border is filled by pad_frame().             */
+{
+	static FIL fobj;
+    CImage header;
+    uint8 sector[PNM_SECTOR] __attribute__((aligned(FRAME_ALIGN)));
+    uint8 *data;
+    unsigned int nbytes, first, size;
+    int idx, length;
+
+	if (f_open(&fobj, filename, FA_READ))
+	{
+        printf("read_pnm_frame: cannot open '%s'.\n", filename);
+		return 1;
+	}
+    if ((length = read_pnm_sector(&fobj, &header, sector, &nbytes)) == 0)
+    {
+        printf("read_pnm_frame: unsupported image file.\n");
+        f_close(&fobj);
+        return 1;
+    }
+    if (header.depth != 8)
     {
-        printf("read_pnm_image: incorrect image format parameter(s).\n");
+        printf("read_pnm_frame: only 8-bit gray images are supported.\n");
+        f_close(&fobj);
         return 1;
     }
 
-    /* read the image data */
-    image_line = image->width*image->depth/8;
-    image->pix = ptr = get_memory("image->pix", image->height*image_line);
-    for (idx = 0; idx < image->height; idx++)
+    /* Read the image data in one request to the start of the buffer,  */
+    /* with the sector boundaries on aligned addresses, then move the  */
+    /* rows up into place from the last one. A row never moves down    */
+    /* as the border holds at least FRAME_ALIGN bytes; without a border */
+    /* the data starts at the buffer, unaligned.                        */
+    alloc_frame(frame, header.width, header.height, pad);
+    size = (unsigned int) frame->width*frame->height;
+    first = nbytes - length;
+    first = (first < size)? first : size;
+    data = frame->mem;
+    if (frame->pad > 0)
     {
-        f_read(&fobj, (void *) ptr, image_line, &nbytes);
-        if (nbytes != image_line)
-        {
-            printf("read_pnm_image: image read error.\n");
-            return 1;
-        }
-        ptr += image_line;
+        data += (FRAME_ALIGN - first) & (FRAME_ALIGN-1);
+    }
+    memcpy(data, sector + length, first);
+    nbytes = 0;
+    if (first < size)
+    {
+        f_read(&fobj, (void *) (data + first), size - first, &nbytes);
     }
     f_close(&fobj);
+    if (first + nbytes != size)
+    {
+        printf("read_pnm_frame: image read error.\n");
+        free_frame(frame);
+        return 1;
+    }
+    for (idx = frame->height-1; idx >= 0; idx--)
+    {
+        memmove(frame->pix + idx*frame->stride, data + idx*frame->width,
+                frame->width);
+    }
+    pad_frame(frame);
     return 0;
 }
 
-int write_pnm_image(const char *filename, CImage *image)
+static int32 morton_coord(uint32 code)
+/* Extract the coordinate held in the even bits of a Morton code. */
 {
-	static FIL fobj;
-    char buf[32];
-    int idx;
-    uint8 *ptr;
-    unsigned int nbytes;
-    size_t image_line;
+    int32 v = 0, bit;
 
-    if (image->depth != 8 && image->depth != 24)
+    for (bit = 0; code; bit++, code >>= 2)
     {
-        printf("write_pnm_image: unsupported image depth.\n");
-        return 1;
+        v |= (code & 1) << bit;
     }
+    return v;
+}
 
-	if (f_open(&fobj, filename, FA_CREATE_ALWAYS | FA_WRITE))
+static uint32 tframe_bytes(TFrame *frame)
+/* Size of the pool buffer of a tiled frame: the tiles and the tile table. */
+{
+    return frame->tiles_x*frame->tiles_y
+           * (TILE_SIZE*TILE_SIZE + sizeof(uint8 *));
+}
+
+void alloc_tframe(TFrame *frame, int32 width, int32 height, int32 pad)
+/* Allocate a tiled frame with a border of at least pad pixels. The border */
+/* is rounded up to TILE_SIZE. The tiles are numbered in Morton order over */
+/* the smallest power-of-two square holding the grid; the codes outside    */
+/* the grid are skipped, so the tiles are stored without gaps. The tile    */
+/* table follows the tiles in the same pool buffer.                        */
+{
+    uint32 code, side;
+    int32  tx, ty, n;
+
+    pad = (pad + TILE_MASK) & ~TILE_MASK;
+    frame->width = width, frame->height = height;
+    frame->pad = pad;
+    frame->tiles_x = (width + 2*pad + TILE_MASK) >> TILE_SHIFT;
+    frame->tiles_y = (height + 2*pad + TILE_MASK) >> TILE_SHIFT;
+    n = frame->tiles_x*frame->tiles_y;
+    frame->mem = pool_get("tframe->mem", tframe_bytes(frame));
+    frame->tile = (uint8 **) (frame->mem + n*TILE_SIZE*TILE_SIZE);
+
+    for (side = 1; side < (uint32) frame->tiles_x
+         || side < (uint32) frame->tiles_y; side <<= 1)
+        ;
+    for (code = n = 0; code < side*side; code++)
+    {
+        tx = morton_coord(code), ty = morton_coord(code >> 1);
+        if (tx < frame->tiles_x && ty < frame->tiles_y)
+        {
+            frame->tile[ty*frame->tiles_x + tx] = frame->mem
+                + n++ * (TILE_SIZE*TILE_SIZE);
+        }
+    }
+}
+
+void free_tframe(TFrame *frame)
+{
+    pool_put(frame->mem, tframe_bytes(frame));
+    frame->mem = NULL, frame->tile = NULL;
+}
+
+void get_tframe_row(TFrame *frame, int32 x, int32 y, uint8 *dst, int32 n)
+/* Copy the n pixels of row y starting at column x to dst. */
+{
+    int32 len;
+
+    while (n > 0)
+    {
+        len = TILE_SIZE - ((x + frame->pad) & TILE_MASK);
+        len = (len < n)? len : n;
+        memcpy(dst, TPIX(frame, x, y), len);
+        x += len, dst += len, n -= len;
+    }
+}
+
+void put_tframe_row(TFrame *frame, int32 x, int32 y, uint8 *src, int32 n)
+/* Copy n pixels from src to row y of the frame, starting at column x. */
+{
+    int32 len;
+
+    while (n > 0)
+    {
+        len = TILE_SIZE - ((x + frame->pad) & TILE_MASK);
+        len = (len < n)? len : n;
+        memcpy(TPIX(frame, x, y), src, len);
+        x += len, src += len, n -= len;
+    }
+}
+
+static void pad_tframe_line(TFrame *frame, uint8 *line)
+/* line holds a row of the tile grid with the image pixels at line+pad; */
+/* replicate the outermost pixels into the rest of the line.            */
+{
+    int32 pad = frame->pad, width = frame->width;
+
+    memset(line, line[pad], pad);
+    memset(line + pad + width, line[pad + width-1],
+           frame->tiles_x*TILE_SIZE - pad - width);
+}
+
+static void pad_tframe_rows(TFrame *frame, uint8 *line)
+/* Fill the border rows above and below the image from its first and */
+/* last rows, which must already be padded horizontally.             */
+{
+    int32 y, grid = frame->tiles_x*TILE_SIZE;
+
+    get_tframe_row(frame, -frame->pad, 0, line, grid);
+    for (y = -frame->pad; y < 0; y++)
+    {
+        put_tframe_row(frame, -frame->pad, y, line, grid);
+    }
+    get_tframe_row(frame, -frame->pad, frame->height-1, line, grid);
+    for (y = frame->height; y < frame->tiles_y*TILE_SIZE - frame->pad; y++)
+    {
+        put_tframe_row(frame, -frame->pad, y, line, grid);
+    }
+}
+
+void pad_tframe(TFrame *frame)
+/* Fill the border of a tiled frame by replicating the outermost pixels. */
+{
+    uint8 *line;
+    int32 y, grid = frame->tiles_x*TILE_SIZE;
+
+    line = get_memory("pad_tframe", grid);
+    for (y = 0; y < frame->height; y++)
+    {
+        get_tframe_row(frame, 0, y, line + frame->pad, frame->width);
+        pad_tframe_line(frame, line);
+        put_tframe_row(frame, -frame->pad, y, line, grid);
+    }
+    pad_tframe_rows(frame, line);
+    release_memory(line);
+}
+
+int read_pnm_tframe(const char *filename, TFrame *frame, int32 pad)
+/* Read an 8-bit PGM image straight into a newly allocated tiled frame  */
+/* with a border of at least pad pixels. Each row is read into a line   */
+/* buffer, padded and scattered over the tiles it crosses.              */
+{
+	static FIL fobj;
+    CImage header;
+    unsigned int nbytes;
+    uint8 *line;
+    int idx;
+
+	if (f_open(&fobj, filename, FA_READ))
 	{
-        printf("write_pnm_image: cannot open '%s'.\n", filename);
+        printf("read_pnm_tframe: cannot open '%s'.\n", filename);
 		return 1;
 	}
-
-    /* write PGM headers */
-    strncpy(buf, (image->depth == 8)? "P5\n" : "P6\n", sizeof(buf));
-	f_write(&fobj, (void *) buf, strlen(buf), &nbytes);
-    if (nbytes != strlen(buf))
+    if (read_pnm_header(&fobj, &header))
     {
-        printf("write_pnm_image: Error writing PGM signature.\n");
+        printf("read_pnm_tframe: unsupported image file.\n");
+        f_close(&fobj);
         return 1;
     }
-
-    /* write width, height, and max level */
-    snprintf(buf, sizeof(buf), "%ld %ld\n255\n", image->width, image->height);
-	f_write(&fobj, (void *) buf, strlen(buf), &nbytes);
-    if (nbytes != strlen(buf))
+    if (header.depth != 8)
     {
-        printf("write_pnm_image: Error writing PGM header.\n");
+        printf("read_pnm_tframe: only 8-bit gray images are supported.\n");
+        f_close(&fobj);
         return 1;
     }
 
-    /* write the image */
-    image_line = image->width*image->depth/8;
-    ptr = image->pix;
-    for (idx = 0; idx < image->height; idx++)
+    alloc_tframe(frame, header.width, header.height, pad);
+    line = get_memory("read_pnm_tframe", frame->tiles_x*TILE_SIZE);
+    for (idx = 0; idx < frame->height; idx++)
     {
-    	f_write(&fobj, (void *) ptr, image_line, &nbytes);
-        if (nbytes != image_line)
+        f_read(&fobj, (void *) (line + frame->pad), frame->width, &nbytes);
+        if (nbytes != frame->width)
         {
-            printf("write_pnm_image: image write error.\n");
+            printf("read_pnm_tframe: image read error.\n");
+            f_close(&fobj);
+            release_memory(line);
             return 1;
         }
-        ptr += image_line;
+        pad_tframe_line(frame, line);
+        put_tframe_row(frame, -frame->pad, idx, line,
+                       frame->tiles_x*TILE_SIZE);
     }
     f_close(&fobj);
+    pad_tframe_rows(frame, line);
+    release_memory(line);
+    return 0;
+}
+
+/* File objects of the open PnmReaders. */
+#define PNM_READERS 4
+static FIL pnm_files[PNM_READERS];
+static int pnm_open[PNM_READERS];
+
+int open_pnm_rows(const char *filename, PnmReader *reader)
+/* Open an 8-bit PGM file and read its header. The rows are then read */
+/* in order with read_pnm_rows(). The reader functions print nothing, */
+/* so they can run on CPU1 (see amp.h); they return 1 on any error.   */
+{
+    CImage header;
+    int slot;
+
+    for (slot = 0; slot < PNM_READERS && pnm_open[slot]; slot++)
+        ;
+    if (slot == PNM_READERS || f_open(&pnm_files[slot], filename, FA_READ))
+    {
+        return 1;
+    }
+    if (read_pnm_header(&pnm_files[slot], &header) || header.depth != 8)
+    {
+        f_close(&pnm_files[slot]);
+        return 1;
+    }
+    pnm_open[slot] = 1;
+    reader->slot = slot;
+    reader->width = header.width, reader->height = header.height;
+    reader->next = 0;
     return 0;
 }
+
+int read_pnm_rows(PnmReader *reader, uint8 *dst, int32 stride, int32 rows)
+/* Read the next rows of the image to dst, dst + stride, ... */
+{
+    FIL *fobj = &pnm_files[reader->slot];
+    unsigned int nbytes, size;
+    uint8 *data;
+    int32 width = reader->width, off, idx;
+
+    if (rows <= 0)
+    {
+        return 0;
+    }
+    if (reader->next + rows > reader->height)
+    {
+        return 1;
+    }
+
+    /* Read the rows in one request, as read_pnm_frame() does, starting */
+    /* off bytes into dst so that the sector boundaries of the file are */
+    /* on aligned addresses, then spread them to the stride. The rows   */
+    /* that move down are moved first to last and the others last to    */
+    /* first. Without room between the rows the data starts at dst,     */
+    /* unaligned.                                                        */
+    size = (unsigned int) width*rows;
+    off = (int32) ((f_tell(fobj) - (size_t) dst) & (FRAME_ALIGN-1));
+    if (off > (rows-1)*(stride-width))
+    {
+        off = 0;
+    }
+    data = dst + off;
+    if (f_read(fobj, (void *) data, size, &nbytes) || nbytes != size)
+    {
+        return 1;
+    }
+    reader->next += rows;
+    if (off == 0 && stride == width)
+    {
+        return 0;
+    }
+    for (idx = 0; idx < rows && idx*(stride-width) < off; idx++)
+    {
+        memmove(dst + idx*stride, data + idx*width, width);
+    }
+    while (--rows >= idx)
+    {
+        memmove(dst + rows*stride, data + rows*width, width);
+    }
+    return 0;
+}
+
+void close_pnm_rows(PnmReader *reader)
+{
+    f_close(&pnm_files[reader->slot]);
+    pnm_open[reader->slot] = 0;
+}
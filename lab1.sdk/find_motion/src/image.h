@@ -34,10 +34,81 @@ typedef struct
     int32 depth;
 } CImage;
 
+/* Row alignment of a CFrame, the cache line size of the Cortex-A9.   */
+#define FRAME_ALIGN 32
+
+/* An 8-bit frame surrounded by a border of pad replicated pixels on  */
+/* all four sides. Every row starts on a FRAME_ALIGN-byte boundary;   */
+/* pix points to the pixel at (0, 0) and pix[y*stride + x] is valid   */
+/* for -pad <= x < width+pad and -pad <= y < height+pad.              */
+typedef struct
+{
+    uint8 *mem;       /* the allocated memory block                   */
+    uint8 *pix;
+    int32 width, height;
+    int32 stride;
+    int32 pad;
+} CFrame;
+
+/* Tiles of a TFrame are TILE_SIZE x TILE_SIZE pixels, 1KB each. */
+#define TILE_SHIFT 5
+#define TILE_SIZE  (1 << TILE_SHIFT)
+#define TILE_MASK  (TILE_SIZE - 1)
+
+/* An 8-bit frame stored in square tiles, with the same border of pad   */
+/* replicated pixels as a CFrame. The tile grid starts at (-pad, -pad)  */
+/* and pad is a multiple of TILE_SIZE, so pixel (0, 0) is the first    */
+/* pixel of a tile. The pixels of a tile are stored row by row, and the */
+/* tiles are laid out in memory in Morton (Z-) order, so the tiles      */
+/* around any block are close together in memory. tile[] maps the tile */
+/* at (tx, ty) of the grid to tile[ty*tiles_x + tx].                    */
+typedef struct
+{
+    uint8 *mem;       /* the allocated memory block                   */
+    uint8 **tile;
+    int32 width, height;
+    int32 tiles_x, tiles_y;
+    int32 pad;
+} TFrame;
+
+/* Address of pixel (x, y) of a TFrame, -pad <= x, y < size+pad. */
+#define TPIX(f, x, y) \
+    ((f)->tile[(((y) + (f)->pad) >> TILE_SHIFT)*(f)->tiles_x \
+               + (((x) + (f)->pad) >> TILE_SHIFT)] \
+     + ((((y) + (f)->pad) & TILE_MASK) << TILE_SHIFT) \
+     + (((x) + (f)->pad) & TILE_MASK))
+
+/* An 8-bit PGM file opened for reading row by row, so that a frame can */
+/* be processed while it is being read without holding all of it.       */
+typedef struct
+{
+    int32 width, height;
+    int32 next;       /* the next row to be read                       */
+    int   slot;       /* the file object in use, see image.c           */
+} PnmReader;
+
 void *get_memory(char *name, int32 size);
+void release_memory(void *p);
 int read_pnm_image(const char *filename, CImage *image);
 int write_pnm_image(const char *filename, CImage *image);
 
+uint32 frame_bytes(int32 width, int32 height, int32 pad);
+void alloc_frame(CFrame *frame, int32 width, int32 height, int32 pad);
+void free_frame(CFrame *frame);
+void pad_frame(CFrame *frame);
+int  read_pnm_frame(const char *filename, CFrame *frame, int32 pad);
+
+void alloc_tframe(TFrame *frame, int32 width, int32 height, int32 pad);
+void free_tframe(TFrame *frame);
+void pad_tframe(TFrame *frame);
+void get_tframe_row(TFrame *frame, int32 x, int32 y, uint8 *dst, int32 n);
+void put_tframe_row(TFrame *frame, int32 x, int32 y, uint8 *src, int32 n);
+int  read_pnm_tframe(const char *filename, TFrame *frame, int32 pad);
+
+int  open_pnm_rows(const char *filename, PnmReader *reader);
+int  read_pnm_rows(PnmReader *reader, uint8 *dst, int32 stride, int32 rows);
+void close_pnm_rows(PnmReader *reader);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,192 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : mailbox.c                                                     */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The inter-core mailboxes of mailbox.h.                                 */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "mailbox.h"
+#include "ocm.h"
+
+#ifndef HOST_BUILD
+#include "gic.h"
+#include "xpseudo_asm.h"
+
+#define sev() __asm__ __volatile__("sev" : : : "memory")
+#define wfe() __asm__ __volatile__("wfe" : : : "memory")
+
+static uint32 load_acquire(MailIndex *p)
+{
+    uint32 v = *p;
+
+    dmb();
+    return v;
+}
+
+static void store_release(MailIndex *p, uint32 v)
+{
+    dmb();
+    *p = v;
+}
+
+static uint32 this_cpu(void)
+{
+    uint32 mpidr;
+
+    __asm__ __volatile__("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+    return mpidr & 0x3;
+}
+
+static void wake(Mailbox *box)
+/* Wake the other core, which may be waiting in WFE or for the SGI. The */
+/* dsb orders the store of head before the load of sgi, as the dsb of   */
+/* mailbox_doorbell() orders the store of sgi before the consumer loads */
+/* head: either the producer sees the doorbell or the consumer sees the */
+/* message and does not wait.                                           */
+{
+    int sgi;
+
+    dsb();
+    sgi = box->sgi;
+    if (sgi >= 0)
+    {
+        dmb();
+        gic_ring(box->cpu, sgi);
+    }
+    sev();
+}
+
+static void doze(Mailbox *box)
+/* Wait for a wake() of the other core, unless a message came since    */
+/* the consumer found the mailbox empty (see gic_wait()).              */
+{
+    if (box->sgi < 0 || box->cpu != this_cpu())
+    {
+        wfe();
+        return;
+    }
+    gic_wait(&box->head, box->tail);
+}
+#else
+#include <sched.h>
+
+static uint32 load_acquire(MailIndex *p)
+{
+    return atomic_load_explicit(p, memory_order_acquire);
+}
+
+static void store_release(MailIndex *p, uint32 v)
+{
+    atomic_store_explicit(p, v, memory_order_release);
+}
+
+static void wake(Mailbox *box)
+{
+}
+
+static void doze(Mailbox *box)
+{
+    sched_yield();
+}
+#endif
+
+Mailbox *mailbox_create(const char *name, int slots)
+/* Allocate a mailbox of slots messages, a power of two, in the OCM. */
+{
+    Mailbox *box;
+
+    ocm_share();
+    box = ocm_alloc(name, sizeof(Mailbox) + slots*sizeof(Message));
+    memset(box, 0, sizeof(Mailbox));
+    box->mask = slots - 1;
+    box->sgi = -1;
+    box->name = name;
+    box->slots = (Message *) (box + 1);
+    return box;
+}
+
+int mailbox_doorbell(Mailbox *box, int sgi)
+/* Called by the consumer: wake it with SGI sgi (0 .. 15) instead of an */
+/* event. The producer may be sending already. Returns 1 if sgi is not */
+/* an SGI.                                                              */
+{
+    if (sgi < 0 || sgi > 15)
+    {
+        return 1;
+    }
+#ifndef HOST_BUILD
+    if (gic_doorbell(sgi))
+    {
+        return 1;
+    }
+    box->cpu = this_cpu();
+    dmb();
+#endif
+    box->sgi = sgi;
+#ifndef HOST_BUILD
+    /* The doorbell before the next load of head (see wake()). */
+    dsb();
+#endif
+    return 0;
+}
+
+int mailbox_send(Mailbox *box, const Message *msg)
+/* Post a message. Returns 1 if the mailbox is full. */
+{
+    uint32 head = load_acquire(&box->head);
+
+    if (head - load_acquire(&box->tail) > box->mask)
+    {
+        return 1;
+    }
+    box->slots[head & box->mask] = *msg;
+    store_release(&box->head, head + 1);
+    wake(box);
+    return 0;
+}
+
+int mailbox_receive(Mailbox *box, Message *msg)
+/* Take the oldest message. Returns 1 if the mailbox is empty. */
+{
+    uint32 tail = load_acquire(&box->tail);
+
+    if (tail == load_acquire(&box->head))
+    {
+        return 1;
+    }
+    *msg = box->slots[tail & box->mask];
+    store_release(&box->tail, tail + 1);
+
+    /* The producer may be waiting for room. */
+#ifndef HOST_BUILD
+    dsb();
+    sev();
+#endif
+    return 0;
+}
+
+void mailbox_send_wait(Mailbox *box, const Message *msg)
+{
+    while (mailbox_send(box, msg))
+    {
+#ifndef HOST_BUILD
+        wfe();
+#else
+        doze(box);
+#endif
+    }
+}
+
+void mailbox_receive_wait(Mailbox *box, Message *msg)
+{
+    while (mailbox_receive(box, msg))
+    {
+        doze(box);
+    }
+}
+
+uint32 mailbox_count(Mailbox *box)
+/* Number of messages waiting, as seen by the calling core. */
+{
+    return load_acquire(&box->head) - load_acquire(&box->tail);
+}
@@ -0,0 +1,67 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : mailbox.h                                                     */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Lock-free single-producer, single-consumer mailboxes between the two  */
+/*  cores, in the OCM. A mailbox is a ring of fixed-size messages: only   */
+/*  the producer writes head and only the consumer writes tail, and each  */
+/*  sits in a cache line of its own. A message is published by a store   */
+/*  of head that is ordered after the message by a dmb, and released by  */
+/*  a store of tail ordered after the reads of the message. The OCM       */
+/*  section is made shareable (see region.h) so the SCU keeps both L1     */
+/*  caches coherent; create the mailboxes before amp_init().             */
+/*                                                                         */
+/*  A blocked consumer waits in WFE, woken by the SEV of every send, or,  */
+/*  once it has called mailbox_doorbell(), in WFI woken by a software     */
+/*  generated interrupt (SGI) the producer sends through the GIC. The     */
+/*  doorbell may be set while the producer is sending: a barrier on each  */
+/*  side makes the producer see it or the consumer see the message. The   */
+/*  consumer waits with gic_wait() (gic.h), which checks head again with  */
+/*  the interrupts masked, so an SGI sent since is not lost.              */
+/*  The producer waits for room in WFE. On the host (HOST_BUILD) the      */
+/*  indices are C11 atomics and the waits yield the thread.               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __MAILBOX_H__
+
+#include "image.h"
+
+#ifdef HOST_BUILD
+#include <stdatomic.h>
+typedef _Atomic uint32 MailIndex;
+#else
+typedef volatile uint32 MailIndex;
+#endif
+
+/* Size of the cache lines of the A9. */
+#define MAIL_LINE 32
+
+typedef struct
+{
+    uint32 type;
+    uint32 arg[3];      /* frame handle, work range, result, ...           */
+} Message;
+
+typedef struct
+{
+    MailIndex head;     /* next slot written by the producer               */
+    uint8     pad0[MAIL_LINE - sizeof(MailIndex)];
+    MailIndex tail;     /* next slot read by the consumer                  */
+    uint8     pad1[MAIL_LINE - sizeof(MailIndex)];
+    uint32    mask;     /* number of slots - 1                             */
+    volatile int    sgi;  /* doorbell SGI of the consumer, or -1           */
+    volatile uint32 cpu;  /* the core of the consumer                      */
+    const char *name;
+    Message   *slots;
+} Mailbox;
+
+Mailbox *mailbox_create(const char *name, int slots);
+int      mailbox_doorbell(Mailbox *box, int sgi);
+int      mailbox_send(Mailbox *box, const Message *msg);
+int      mailbox_receive(Mailbox *box, Message *msg);
+void     mailbox_send_wait(Mailbox *box, const Message *msg);
+void     mailbox_receive_wait(Mailbox *box, Message *msg);
+uint32   mailbox_count(Mailbox *box);
+
+#define __MAILBOX_H__
+#endif
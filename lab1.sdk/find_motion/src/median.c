@@ -0,0 +1,539 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : median.c                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Median filters for noise removal. The 3x3 median is computed with a    */
+/*  branch-free min/max network on VLEN pixels at a time (see simd.h):     */
+/*  each column of three pixels is sorted once into lo/mid/hi, and the     */
+/*  median of a 3x3 neighborhood is then                                   */
+/*                                                                         */
+/*      med3( max(lo[x-1..x+1]), med3(mid[x-1..x+1]), min(hi[x-1..x+1]) ) */
+/*                                                                         */
+/*  Larger kernels use the constant-time algorithm of Perreault and        */
+/*  Hebert, "Median Filtering in Constant Time", IEEE TIP 16(9), 2007.     */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "median.h"
+#include "simd.h"
+#include "ocm.h"
+#include "amp.h"
+#include "pool.h"
+
+/* Parameters of the impulse-noise estimator. See estimate_noise(). */
+#define NOISE_STEP   7
+#define NOISE_LEVEL 48
+
+#define MIN(a, b) ((a) < (b)? (a) : (b))
+#define MAX(a, b) ((a) > (b)? (a) : (b))
+
+/* Two-level histograms used by median_filter(): 16 coarse bins over the */
+/* upper four bits of a pixel, and 256 fine bins.                        */
+#define COARSE 16
+#define FINE   16
+
+/* Median of three values with two min and two max operations. */
+#define MED3(vmin, vmax, a, b, c) vmax(vmin(a, b), vmin(vmax(a, b), c))
+
+OCM_TEXT
+static void sort_columns(uint8 *lo, uint8 *mid, uint8 *hi,
+                         uint8 *r0, uint8 *r1, uint8 *r2, int width)
+/* Sort the three pixels of every column of rows r0, r1, and r2. */
+{
+    int x;
+    vu8 a, b, c, l, h;
+
+    for (x = 0; x+VLEN <= width; x += VLEN)
+    {
+        a = vu8_load(r0+x), b = vu8_load(r1+x), c = vu8_load(r2+x);
+        l = vu8_min(a, b), h = vu8_max(a, b);
+        vu8_store(hi+x, vu8_max(h, c));
+        h = vu8_min(h, c);
+        vu8_store(lo+x, vu8_min(l, h));
+        vu8_store(mid+x, vu8_max(l, h));
+    }
+    for (; x < width; x++)
+    {
+        lo[x]  = MIN(MIN(r0[x], r1[x]), r2[x]);
+        hi[x]  = MAX(MAX(r0[x], r1[x]), r2[x]);
+        mid[x] = MED3(MIN, MAX, r0[x], r1[x], r2[x]);
+    }
+}
+
+OCM_TEXT
+static void median_columns(uint8 *out, uint8 *lo, uint8 *mid, uint8 *hi,
+                           int width)
+/* Compute out[x] for 1 <= x < width-1 from the sorted columns x-1..x+1. */
+{
+    int   x;
+    vu8   maxlo, medmid, minhi;
+    uint8 a, b, c;
+
+    for (x = 1; x+VLEN <= width-1; x += VLEN)
+    {
+        maxlo  = vu8_max(vu8_max(vu8_load(lo+x-1), vu8_load(lo+x)),
+                         vu8_load(lo+x+1));
+        minhi  = vu8_min(vu8_min(vu8_load(hi+x-1), vu8_load(hi+x)),
+                         vu8_load(hi+x+1));
+        medmid = MED3(vu8_min, vu8_max, vu8_load(mid+x-1), vu8_load(mid+x),
+                      vu8_load(mid+x+1));
+        vu8_store(out+x, MED3(vu8_min, vu8_max, maxlo, medmid, minhi));
+    }
+    for (; x < width-1; x++)
+    {
+        a = MAX(MAX(lo[x-1], lo[x]), lo[x+1]);
+        b = MED3(MIN, MAX, mid[x-1], mid[x], mid[x+1]);
+        c = MIN(MIN(hi[x-1], hi[x]), hi[x+1]);
+        out[x] = MED3(MIN, MAX, a, b, c);
+    }
+}
+
+OCM_TEXT
+void median3x3_row(uint8 *dst, uint8 *r0, uint8 *r1, uint8 *r2,
+                   uint8 *buf, int width)
+/* Write the 3x3 median of the middle row r1 to dst. The border pixels   */
+/* dst[0] and dst[width-1] are copied from r1. buf must hold 3*width     */
+/* bytes of scratch space.                                               */
+{
+    sort_columns(buf, buf+width, buf+2*width, r0, r1, r2, width);
+    median_columns(dst, buf, buf+width, buf+2*width, width);
+    dst[0] = r1[0], dst[width-1] = r1[width-1];
+}
+
+void median3x3_band(uint8 *image, int width, int stride, int first, int end,
+                    uint8 *above, uint8 *below, uint8 *buf)
+/* Filter the rows first .. end-1 of the image in place. The unfiltered   */
+/* pixels of rows first-1 and end are read from above and below, so the   */
+/* neighbouring rows may be filtered at the same time. buf holds 5*width  */
+/* bytes. The filtered rows are kept in a 2-line history and written back */
+/* one row late, so every neighborhood is taken from the unfiltered image.*/
+{
+    int   row;
+    uint8 *line[2], *ptr, *r0, *r2;
+
+    line[0] = buf+3*width, line[1] = line[0]+width;
+    for (row = first; row < end; row++)
+    {
+        ptr = image + row*stride;
+        r0 = (row == first)? above : ptr-stride;
+        r2 = (row == end-1)? below : ptr+stride;
+        median3x3_row(line[row & 1], r0, ptr, r2, buf, width);
+
+        /* Row (row-1) is no longer needed as an input. */
+        if (row > first)
+        {
+            memcpy(ptr-stride+1, line[(row-1) & 1]+1, width-2);
+        }
+    }
+    if (end > first)
+    {
+        memcpy(image+(end-1)*stride+1, line[(end-1) & 1]+1, width-2);
+    }
+}
+
+void median3x3(uint8 *image, int width, int height, int stride)
+/* Replace every pixel but the ones on the image border by the median of   */
+/* its 3x3 neighborhood; row y of the image starts at image + y*stride.    */
+{
+    uint8 *buf;
+
+    if (width < 3 || height < 3)
+    {
+        return;
+    }
+    buf = get_memory("median3x3 buffers", 5*width);
+    median3x3_band(image, width, stride, 1, height-1, image,
+                   image + (height-1)*stride, buf);
+    release_memory(buf);
+}
+
+typedef struct
+{
+    uint8 *image;
+    int   width, height, stride;
+    uint8 *above, *below;  /* unfiltered rows around the split            */
+    uint8 *buf[2];         /* buffers of CPU0 and CPU1                    */
+} MedianJob;
+
+static void median_rows(void *arg, int first, int end)
+/* Filter the rows 1+first .. end of a MedianJob. Only the range of CPU1 */
+/* starts after row 1 and only the range of CPU0 ends before the last    */
+/* row, at the split.                                                    */
+{
+    MedianJob *job = arg;
+    uint8 *above, *below;
+
+    first++, end++;
+    above = (first > 1)? job->above : job->image;
+    below = (end < job->height-1)? job->below : job->image + end*job->stride;
+    median3x3_band(job->image, job->width, job->stride, first, end,
+                   above, below, job->buf[first > 1]);
+}
+
+void median3x3_amp(uint8 *image, int width, int height, int stride)
+/* Same as median3x3(), with the rows split between the two cores. */
+{
+    MedianJob job;
+    int split;
+
+    if (width < 3 || height < 3)
+    {
+        return;
+    }
+    job.image = image;
+    job.width = width, job.height = height, job.stride = stride;
+    job.buf[0] = get_memory("median3x3 buffers", 2*5*width + 2*width);
+    job.buf[1] = job.buf[0] + 5*width;
+    job.above = job.buf[1] + 5*width;
+    job.below = job.above + width;
+
+    /* Keep the unfiltered rows on both sides of the split, which the */
+    /* other core overwrites.                                        */
+    split = 1 + amp_split(height-2);
+    if (split < height-1)
+    {
+        memcpy(job.above, image + (split-1)*stride, width);
+        memcpy(job.below, image + split*stride, width);
+    }
+    amp_run(median_rows, &job, height-2);
+    release_memory(job.buf[0]);
+}
+
+typedef struct
+{
+    uint8 **images;
+    int   width, height, stride;
+    int   rows, bands;     /* rows per band, bands per image             */
+    uint8 *edges;          /* unfiltered rows above and below each band  */
+    uint8 *buf;            /* 5*width bytes per pool thread              */
+} BandJob;
+
+static void median_bands(void *arg, int first, int end)
+/* Filter the bands first .. end-1 of a BandJob. Band i is the band */
+/* i%bands of image i/bands.                                        */
+{
+    BandJob *job = arg;
+    uint8 *edges;
+    int   i, top;
+
+    for (i = first; i < end; i++)
+    {
+        top = 1 + (i % job->bands)*job->rows;
+        edges = job->edges + 2*i*job->width;
+        median3x3_band(job->images[i/job->bands], job->width, job->stride,
+                       top, MIN(top + job->rows, job->height-1),
+                       edges, edges + job->width,
+                       job->buf + pool_self()*5*job->width);
+    }
+}
+
+static void split_bands(BandJob *job, int count, int height)
+/* About POOL_SPLIT bands per thread over all the images. */
+{
+    job->bands = (pool_threads*POOL_SPLIT + count-1)/count;
+    job->rows = (height-2 + job->bands-1)/job->bands;
+    job->bands = (height-2 + job->rows-1)/job->rows;
+}
+
+uint32 median3x3_pool_bytes(int count, int width, int height)
+/* Bytes of the frame arena that median3x3_pool() takes. */
+{
+    BandJob job;
+
+    if (width < 3 || height < 3 || count < 1)
+    {
+        return 0;
+    }
+    split_bands(&job, count, height);
+    return (uint32) (pool_threads*5 + count*job.bands*2)*width + FRAME_ALIGN;
+}
+
+void median3x3_pool(uint8 **images, int count, int width, int height,
+                    int stride)
+/* Same as median3x3() on count images of the same size, with the rows */
+/* of all of them cut into bands that the thread pool (see pool.h)     */
+/* filters at once. Call it from the thread that started the pool, as  */
+/* it allocates from the frame arena.                                  */
+{
+    BandJob job;
+    uint8 *image;
+    int   i, top;
+
+    if (width < 3 || height < 3 || count < 1)
+    {
+        return;
+    }
+    job.images = images;
+    job.width = width, job.height = height, job.stride = stride;
+    split_bands(&job, count, height);
+    job.buf = get_memory("median3x3 buffers",
+                         (pool_threads*5 + count*job.bands*2)*width);
+    job.edges = job.buf + pool_threads*5*width;
+
+    /* Keep the unfiltered rows on both sides of every band, which the */
+    /* neighbouring bands overwrite.                                   */
+    for (i = 0; i < count*job.bands; i++)
+    {
+        image = images[i/job.bands];
+        top = 1 + (i % job.bands)*job.rows;
+        memcpy(job.edges + 2*i*width, image + (top-1)*stride, width);
+        memcpy(job.edges + (2*i+1)*width,
+               image + MIN(top + job.rows, height-1)*stride, width);
+    }
+    pool_run(median_bands, &job, count*job.bands);
+    release_memory(job.buf);
+}
+
+float estimate_noise(uint8 *image, int width, int height, int stride)
+/* Estimate the amount of impulse (salt-and-pepper) noise in the image.   */
+/* Only one out of NOISE_STEP*NOISE_STEP pixels is examined: a sample is  */
+/* counted as an impulse if it deviates from the median of its 3x3        */
+/* neighborhood by more than NOISE_LEVEL gray levels. The function        */
+/* returns the percentage of samples that are impulses.                   */
+{
+    int   row, col, x, count, total;
+    uint8 lo[3], mid[3], hi[3], med[3], *ptr;
+
+    count = total = 0;
+    for (row = 1; row < height-1; row += NOISE_STEP)
+    {
+        for (col = 1; col < width-1; col += NOISE_STEP)
+        {
+            ptr = image + row*stride + col;
+            sort_columns(lo, mid, hi, ptr-stride-1, ptr-1, ptr+stride-1, 3);
+            median_columns(med, lo, mid, hi, 3);
+            x = *ptr - med[1];
+            if (x > NOISE_LEVEL || x < -NOISE_LEVEL)
+            {
+                count++;
+            }
+            total++;
+        }
+    }
+    return (total > 0)? 100.0f*count/total : 0.0f;
+}
+
+static void add_hist(uint16 *dst, uint16 *src, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) dst[i] += src[i];
+}
+
+static void sub_hist(uint16 *dst, uint16 *src, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) dst[i] -= src[i];
+}
+
+static void update_columns(uint16 *col_coarse, uint16 *col_fine,
+                           uint8 *ptr, int width, int delta)
+/* Add (delta = 1) or remove (delta = -1) a row to the column histograms. */
+{
+    int x;
+
+    for (x = 0; x < width; x++)
+    {
+        col_coarse[x*COARSE + (ptr[x] >> 4)] += delta;
+        col_fine[x*COARSE*FINE + ptr[x]] += delta;
+    }
+}
+
+void median_filter(uint8 *image, int width, int height, int stride,
+                   int radius)
+/* Replace every pixel farther than radius from the image border by the   */
+/* median of its (2*radius+1)x(2*radius+1) neighborhood. The cost per     */
+/* pixel does not depend on the radius:                                   */
+/*                                                                        */
+/*  - every column keeps a histogram of the 2*radius+1 pixels above and   */
+/*    below the current row, updated by one add and one remove per row;   */
+/*  - the kernel histogram slides along the row by adding the column      */
+/*    entering on the right and removing the one leaving on the left;     */
+/*  - only the coarse kernel histogram is updated for every pixel. A fine */
+/*    segment is brought up to date when the median search enters its    */
+/*    coarse bin, either incrementally or, if it is more than a kernel    */
+/*    width behind, from scratch.                                         */
+/*                                                                        */
+/* Like median3x3(), the filtered rows are kept in a history of radius+1 */
+/* lines and written back once they are no longer an input.              */
+{
+    uint16 *col_coarse, *col_fine, coarse[COARSE], fine[COARSE*FINE];
+    int    fine_pos[COARSE];
+    int    size, half, row, x, c, b, sum, i;
+    uint8  *lines, *out;
+
+    if (radius == 1)
+    {
+        median3x3(image, width, height, stride);
+        return;
+    }
+    size = 2*radius+1;
+    if (radius < 1 || width < size || height < size)
+    {
+        return;
+    }
+    half = size*size/2;
+    col_coarse = get_memory("median_filter coarse",
+                            width*COARSE*sizeof(uint16));
+    col_fine = get_memory("median_filter fine",
+                          width*COARSE*FINE*sizeof(uint16));
+    lines = get_memory("median_filter lines", (radius+1)*width);
+    memset(col_coarse, 0, width*COARSE*sizeof(uint16));
+    memset(col_fine, 0, width*COARSE*FINE*sizeof(uint16));
+
+    /* The column histograms of the first output row. */
+    for (row = 0; row < size-1; row++)
+    {
+        update_columns(col_coarse, col_fine, image+row*stride, width, 1);
+    }
+
+    for (row = radius; row < height-radius; row++)
+    {
+        /* Slide the column histograms down by one row. The output of   */
+        /* row (row-radius-1) sits in the same history slot as the      */
+        /* output of this row and can go back to the image now.         */
+        out = lines + (row % (radius+1))*width;
+        if (row > radius)
+        {
+            update_columns(col_coarse, col_fine,
+                           image+(row-radius-1)*stride, width, -1);
+            if (row-radius-1 >= radius)
+            {
+                memcpy(image+(row-radius-1)*stride+radius, out+radius,
+                       width-size+1);
+            }
+        }
+        update_columns(col_coarse, col_fine,
+                       image+(row+radius)*stride, width, 1);
+
+        /* The coarse kernel histogram at the first output column. */
+        memset(coarse, 0, sizeof(coarse));
+        for (c = 0; c < size; c++)
+        {
+            add_hist(coarse, col_coarse + c*COARSE, COARSE);
+        }
+        for (b = 0; b < COARSE; b++)
+        {
+            fine_pos[b] = -size;
+        }
+
+        for (x = radius; x < width-radius; x++)
+        {
+            if (x > radius)
+            {
+                add_hist(coarse, col_coarse + (x+radius)*COARSE, COARSE);
+                sub_hist(coarse, col_coarse + (x-radius-1)*COARSE, COARSE);
+            }
+
+            /* Find the coarse bin holding the median. */
+            for (sum = 0, b = 0; sum + coarse[b] <= half; b++)
+            {
+                sum += coarse[b];
+            }
+
+            /* Bring the fine segment of that bin up to date. */
+            if (x - fine_pos[b] > size)
+            {
+                memset(fine + b*FINE, 0, FINE*sizeof(uint16));
+                for (c = x-radius; c <= x+radius; c++)
+                {
+                    add_hist(fine + b*FINE, col_fine + (c*COARSE+b)*FINE, FINE);
+                }
+            }
+            else
+            {
+                for (c = fine_pos[b]+1; c <= x; c++)
+                {
+                    add_hist(fine + b*FINE,
+                             col_fine + ((c+radius)*COARSE+b)*FINE, FINE);
+                    sub_hist(fine + b*FINE,
+                             col_fine + ((c-radius-1)*COARSE+b)*FINE, FINE);
+                }
+            }
+            fine_pos[b] = x;
+
+            /* Find the median within the fine segment. */
+            for (i = 0; sum + fine[b*FINE+i] <= half; i++)
+            {
+                sum += fine[b*FINE+i];
+            }
+            out[x] = (uint8) (b*FINE + i);
+        }
+    }
+
+    /* Write back the rows still in the history. */
+    for (row = (height-size > radius)? height-size : radius;
+         row < height-radius; row++)
+    {
+        memcpy(image+row*stride+radius, lines+(row % (radius+1))*width+radius,
+               width-size+1);
+    }
+    release_memory(col_coarse);
+}
+
+void median3x3_tiled(TFrame *frame)
+/* Same as median3x3() on a tiled frame, followed by pad_tframe(). Each  */
+/* tile is gathered with a one-pixel apron into a small window and its   */
+/* filtered rows go to a second set of tiles, which then replaces the    */
+/* tiles of the frame. Only the TILE_SIZE+2 window rows and the output   */
+/* tile are touched per tile, so the working set stays within the L1.    */
+{
+    TFrame out;
+    uint8  *win, *buf, *line;
+    int32  tx, ty, x0, y0, y, span;
+
+    if (frame->width < 3 || frame->height < 3)
+    {
+        return;
+    }
+    span = TILE_SIZE+2;
+    alloc_tframe(&out, frame->width, frame->height, frame->pad);
+    win = get_memory("median3x3_tiled window", span*span);
+    buf = get_memory("median3x3_tiled buffers", 4*span);
+    line = buf + 3*span;
+
+    /* Filter the tiles that hold image pixels. */
+    for (ty = frame->pad >> TILE_SHIFT; ty < out.tiles_y; ty++)
+    {
+        y0 = (ty << TILE_SHIFT) - frame->pad;
+        if (y0 >= frame->height)
+        {
+            break;
+        }
+        for (tx = frame->pad >> TILE_SHIFT; tx < out.tiles_x; tx++)
+        {
+            x0 = (tx << TILE_SHIFT) - frame->pad;
+            if (x0 >= frame->width)
+            {
+                break;
+            }
+            for (y = 0; y < span; y++)
+            {
+                get_tframe_row(frame, x0-1, y0-1+y, win + y*span, span);
+            }
+            for (y = 0; y < TILE_SIZE; y++)
+            {
+                median3x3_row(line, win + y*span, win + (y+1)*span,
+                              win + (y+2)*span, buf, span);
+                memcpy(TPIX(&out, x0, y0+y), line+1, TILE_SIZE);
+            }
+        }
+    }
+
+    /* The pixels on the image border are not filtered. */
+    line = get_memory("median3x3_tiled line", frame->width);
+    get_tframe_row(frame, 0, 0, line, frame->width);
+    put_tframe_row(&out, 0, 0, line, frame->width);
+    get_tframe_row(frame, 0, frame->height-1, line, frame->width);
+    put_tframe_row(&out, 0, frame->height-1, line, frame->width);
+    for (y = 1; y < frame->height-1; y++)
+    {
+        *TPIX(&out, 0, y) = *TPIX(frame, 0, y);
+        *TPIX(&out, frame->width-1, y) = *TPIX(frame, frame->width-1, y);
+    }
+    pad_tframe(&out);
+
+    release_memory(win);
+    free_tframe(frame);
+    *frame = out;
+}
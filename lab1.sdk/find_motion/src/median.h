@@ -0,0 +1,28 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : median.h                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Median filters and the impulse-noise estimator used to decide whether  */
+/*  a frame needs to be filtered at all.                                   */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __MEDIAN_H__
+
+#include "image.h"
+
+void  median3x3(uint8 *image, int width, int height, int stride);
+void  median3x3_band(uint8 *image, int width, int stride, int first, int end,
+                     uint8 *above, uint8 *below, uint8 *buf);
+void  median3x3_amp(uint8 *image, int width, int height, int stride);
+void  median3x3_pool(uint8 **images, int count, int width, int height,
+                     int stride);
+uint32 median3x3_pool_bytes(int count, int width, int height);
+void  median3x3_row(uint8 *dst, uint8 *r0, uint8 *r1, uint8 *r2,
+                    uint8 *buf, int width);
+void  median_filter(uint8 *image, int width, int height, int stride,
+                    int radius);
+void  median3x3_tiled(TFrame *frame);
+float estimate_noise(uint8 *image, int width, int height, int stride);
+
+#define __MEDIAN_H__
+#endif
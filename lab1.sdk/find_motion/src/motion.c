@@ -0,0 +1,693 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : motion.c                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Full-search block motion estimation, either on two whole frames that   */
+/*  have already been prefiltered or in streaming mode, where the median   */
+/*  filter produces the rows just ahead of the block row being searched.   */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include <limits.h>
+#include "motion.h"
+#include "median.h"
+#include "ocm.h"
+#include "amp.h"
+#include "pool.h"
+#include "task.h"
+#include "prefetch.h"
+
+/* Rows held by the ring buffers of the streaming mode. A block row at y   */
+/* needs the reference rows y-SRANGE .. y+BSIZE+SRANGE-2 and the current  */
+/* rows y .. y+BSIZE-1.                                                    */
+#define PREV_ROWS (2*SRANGE + BSIZE)
+#define CURR_ROWS (BSIZE)
+
+/* Lines of the OCM rings of prefetch_search(): the rows of one block row */
+/* plus the MSTEP rows being prefetched for the next one.                 */
+#define PREV_LINES (2*SRANGE + BSIZE + MSTEP)
+#define CURR_LINES (BSIZE + MSTEP)
+
+/* Size of the search window of a block, as gathered from a TFrame. */
+#define WSIZE (2*SRANGE + BSIZE)
+
+/* Width of the lines of the sliding windows of full_search_tiled(): the */
+/* WSIZE reference lines and the BSIZE current lines fit in STRIP_CACHE. */
+#define SLIDE_WIDTH (STRIP_CACHE/(WSIZE + BSIZE))
+
+/* A frame whose filtered rows are produced on demand into a ring buffer. */
+/* The rows come either from a frame in memory or from a file being read */
+/* row by row, of which only the last three rows are kept. The ring      */
+/* lines have the stride and border of a CFrame of the same size.        */
+typedef struct
+{
+    CFrame    *src;     /* the unfiltered source frame, or NULL         */
+    PnmReader *file;    /* the file the rows are read from, or NULL     */
+    int32 width, height;
+    int32 stride, pad;
+    uint8 **table;   /* row table from row -pad to row height+pad-1     */
+    uint8 **rows;    /* table + pad, indexed by the row number          */
+    uint8 *ring;     /* nrows filtered lines                            */
+    uint8 *raw;      /* the last three rows read from the file          */
+    uint8 *buf;      /* scratch space of median3x3_row()                */
+    int   nrows;
+    int   next;      /* the next row to be filtered                     */
+    int   filter;    /* 0 if the source rows are used as they are       */
+    int   error;     /* set if the file could not be read               */
+} RowStream;
+
+/* Set to 0 to keep the windows of strip_search() in the DDR. */
+int ocm_scratch = 1;
+
+/* Set to yield to the other tasks (see task.h) after every block. */
+int search_yields = 0;
+
+OCM_TEXT
+int32 compute_sad(uint8 **prev, uint8 **curr, int px, int py, int cx, int cy)
+{
+    int x, y;
+    int sad = 0;
+
+    for (y = 0; y < BSIZE; y++)
+    {
+        for (x = 0; x < BSIZE; x++)
+        {
+            /* compute the sum of absolute difference */
+            sad += abs(prev[py+y][px+x] - curr[cy+y][cx+x]);
+        }
+    }
+    return sad;
+}
+
+OCM_TEXT
+int match(int *x, int *y, int posx, int posy, uint8 **prev, uint8 **curr)
+/* Try to find the best match of the 16x16 block located at (idx, idy) of    */
+/* the current image in the search window of the previous image. The search  */
+/* window is defined as a 32x32 area in the previous image at the location   */
+/* centered around the block position (idx, idy).                            */
+/* The motion vector of both x and y components range from -16 to 15 pixels. */
+{
+    int min_sad, sad, mvx, mvy;
+
+    /* Set the matching error to the largest integer value; the first */
+    /* candidate always replaces the vector set here.                  */
+    min_sad = INT_MAX;
+    *x = -SRANGE, *y = -SRANGE;
+    for (mvy = -SRANGE; mvy < SRANGE; mvy++)
+    {
+        for (mvx = -SRANGE; mvx < SRANGE; mvx++)
+        {
+            /* Trying to compute the matching cost at (posx, posy) */
+            sad = compute_sad(prev, curr, posx+mvx, posy+mvy, posx, posy);
+
+            /* If the matching cost is minimal, record it */
+            if (sad <= min_sad)
+            {
+                min_sad = sad;
+                *x = mvx, *y = mvy;
+            }
+        }
+    }
+    return min_sad;
+}
+
+void search_block_row(MVector *mv, uint8 **prev_rows, uint8 **curr_rows,
+                      int32 width, int idy)
+/* Find the motion vectors of block row idy. Only the rows of the search */
+/* windows of this block row must be valid in the row tables.            */
+{
+    int idx, nx;
+    int x, y;
+
+    nx = width/MSTEP;
+    for (idx = 0; idx < nx; idx++)
+    {
+        /* Find the best match of the current block in the previous frame. */
+        (void) match(&x, &y, (idx*MSTEP), (idy*MSTEP), prev_rows, curr_rows);
+
+        /* Store the motion vector at the current position. */
+        mv[idy*nx+idx].x = x, mv[idy*nx+idx].y = y;
+        if (search_yields)
+        {
+            task_yield();
+        }
+    }
+}
+
+static uint8 **frame_rows(CFrame *frame)
+/* Build the row table of a padded frame, including the border rows. The */
+/* returned table is indexed by row number; release it with             */
+/* release_memory(rows-pad).                                             */
+{
+    uint8 **rows;
+    int   row;
+
+    rows = get_memory("frame_rows",
+                      (frame->height + 2*frame->pad)*sizeof(uint8 *));
+    rows += frame->pad;
+    for (row = -frame->pad; row < frame->height + frame->pad; row++)
+    {
+        rows[row] = frame->pix + row*frame->stride;
+    }
+    return rows;
+}
+
+void full_search(MVector *mv, CFrame *prev, CFrame *curr)
+/* Use full-search algorithm to find the motion vectors of the second */
+/* frame (curr) w.r.t. the first frame (prev). Both frames must have  */
+/* a border of at least FRAME_PAD pixels.                             */
+{
+    int idy, ny;
+    uint8 **prev_rows, **curr_rows;
+
+    /* Compute the number of movtion vectors per frame. */
+    ny = curr->height/MSTEP;
+
+    /* Although we declare mv[] as an 1D array, it is actually used as a 2D */
+    /* array in row-major arrangement.  The width and height of mv[] are nx */
+    /* and ny. For example, if the image size is 720x480, there are 45x30   */
+    /* motion vectors.                                                      */
+    prev_rows = frame_rows(prev);
+    curr_rows = frame_rows(curr);
+
+    /* Looping through the computation of all the nx*ny motion vectors.     */
+    /* The search windows of the boundary blocks extend into the borders of */
+    /* the frames, which replicate the outermost pixels.                    */
+    for (idy = 0; idy < ny; idy++)
+    {
+        search_block_row(mv, prev_rows, curr_rows, curr->width, idy);
+    }
+    release_memory(prev_rows - prev->pad);
+}
+
+typedef struct
+{
+    MVector *mv;
+    uint8   **prev_rows, **curr_rows;
+    int32   width;
+} SearchJob;
+
+static void search_rows(void *arg, int first, int end)
+/* Search the block rows first .. end-1 of a SearchJob. */
+{
+    SearchJob *job = arg;
+    int idy;
+
+    for (idy = first; idy < end; idy++)
+    {
+        search_block_row(job->mv, job->prev_rows, job->curr_rows,
+                         job->width, idy);
+    }
+}
+
+void full_search_amp(MVector *mv, CFrame *prev, CFrame *curr)
+/* Same as full_search(), with the block rows split between the two    */
+/* cores. Each core writes the vectors of its own block rows only.     */
+{
+    SearchJob job;
+
+    job.mv = mv;
+    job.prev_rows = frame_rows(prev);
+    job.curr_rows = frame_rows(curr);
+    job.width = curr->width;
+    amp_run(search_rows, &job, curr->height/MSTEP);
+    release_memory(job.prev_rows - prev->pad);
+}
+
+typedef struct
+{
+    SearchJob *pairs;
+    int       rows;        /* block rows of a frame                      */
+} PairsJob;
+
+static void search_pairs(void *arg, int first, int end)
+/* Search the block rows first .. end-1 of a PairsJob. Block row i is */
+/* the block row i%rows of pair i/rows.                               */
+{
+    PairsJob  *job = arg;
+    SearchJob *pair;
+    int i;
+
+    for (i = first; i < end; i++)
+    {
+        pair = &job->pairs[i/job->rows];
+        search_block_row(pair->mv, pair->prev_rows, pair->curr_rows,
+                         pair->width, i % job->rows);
+    }
+}
+
+void full_search_pool(MVector **mv, CFrame **prev, CFrame **curr, int count)
+/* Same as full_search() on count pairs of frames of the same size, with */
+/* the block rows of all the pairs searched at once by the thread pool   */
+/* (see pool.h). Each block row is written by one thread only.           */
+{
+    PairsJob job;
+    int i;
+
+    if (count < 1)
+    {
+        return;
+    }
+    job.pairs = get_memory("search jobs", count*sizeof(SearchJob));
+    job.rows = curr[0]->height/MSTEP;
+    for (i = 0; i < count; i++)
+    {
+        job.pairs[i].mv = mv[i];
+        job.pairs[i].prev_rows = frame_rows(prev[i]);
+        job.pairs[i].curr_rows = frame_rows(curr[i]);
+        job.pairs[i].width = curr[i]->width;
+    }
+    pool_run(search_pairs, &job, count*job.rows);
+    release_memory(job.pairs);
+}
+
+uint32 full_search_pool_bytes(int count, CFrame *frame)
+/* Bytes of the frame arena that full_search_pool() takes for count    */
+/* pairs of frames of the size and border of frame: the jobs, and the */
+/* row tables of both frames of every pair.                           */
+{
+    uint32 rows = (frame->height + 2*frame->pad)*sizeof(uint8 *);
+
+    return count*sizeof(SearchJob) + FRAME_ALIGN
+           + 2*count*((rows + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1));
+}
+
+static long slide_window(uint8 **rows, uint8 *lines, int nlines, int width,
+                         CFrame *frame, int x, int *next, int end)
+/* Copy the rows from *next up to (excluding) end of the frame, starting */
+/* at column x, into a ring of nlines lines of width pixels and point    */
+/* rows[] at them. Returns the number of bytes copied.                   */
+{
+    long bytes = 0;
+
+    for (; *next < end; (*next)++)
+    {
+        rows[*next] = lines + ((*next + nlines) % nlines)*width;
+        memcpy(rows[*next], frame->pix + *next*frame->stride + x, width);
+        bytes += width;
+    }
+    return bytes;
+}
+
+long strip_search(MVector *mv, CFrame *prev, CFrame *curr)
+/* Same as full_search(), but the blocks are visited in vertical strips   */
+/* of STRIP_BLOCKS blocks, top to bottom. The reference rows covered by   */
+/* the search windows of a strip are copied into a ring of WSIZE lines,   */
+/* and the current rows into a ring of BSIZE lines, so moving down one    */
+/* block row copies only MSTEP new rows of each and the windows stay in  */
+/* the L1. The windows are in the OCM if ocm_scratch is set. The kernels  */
+/* address them with column numbers relative to the left edge of the     */
+/* strip window (x0-SRANGE). Returns the number of bytes read from the   */
+/* two frames.                                                            */
+{
+    uint8 *lines, **table, **prev_rows, **curr_rows;
+    int   idx, idy, nx, ny, x0, count, width, prev_next, curr_next, i;
+    int   mvx, mvy;
+    uint32 size, mark = 0;
+    long  bytes = 0;
+
+    nx = curr->width/MSTEP;
+    ny = curr->height/MSTEP;
+    size = (WSIZE + BSIZE)*((STRIP_BLOCKS-1)*MSTEP + WSIZE);
+    if (ocm_scratch)
+    {
+        mark = arena_mark(&ocm_arena);
+        lines = ocm_alloc("strip windows", size);
+    }
+    else
+    {
+        lines = get_memory("strip windows", size);
+    }
+    table = get_memory("strip rows",
+                       (2*curr->height + 2*prev->pad + 2*curr->pad)
+                       *sizeof(uint8 *));
+    prev_rows = table + prev->pad;
+    curr_rows = prev_rows + curr->height + prev->pad + curr->pad;
+
+    for (idx = 0; idx < nx; idx += STRIP_BLOCKS)
+    {
+        x0 = idx*MSTEP;
+        count = (nx-idx < STRIP_BLOCKS)? nx-idx : STRIP_BLOCKS;
+        width = (count-1)*MSTEP + WSIZE;
+
+        /* Slide the windows down the strip. */
+        prev_next = -SRANGE, curr_next = 0;
+        for (idy = 0; idy < ny; idy++)
+        {
+            bytes += slide_window(prev_rows, lines, WSIZE, width, prev,
+                                  x0-SRANGE, &prev_next,
+                                  idy*MSTEP + BSIZE + SRANGE - 1);
+            bytes += slide_window(curr_rows, lines + WSIZE*width, BSIZE,
+                                  width, curr, x0-SRANGE, &curr_next,
+                                  idy*MSTEP + BSIZE);
+            for (i = 0; i < count; i++)
+            {
+                (void) match(&mvx, &mvy, i*MSTEP + SRANGE, idy*MSTEP,
+                             prev_rows, curr_rows);
+                mv[idy*nx+idx+i].x = mvx, mv[idy*nx+idx+i].y = mvy;
+            }
+        }
+    }
+    if (ocm_scratch)
+    {
+        release_memory(table);
+        arena_release(&ocm_arena, mark);
+    }
+    else
+    {
+        release_memory(lines);
+    }
+    return bytes;
+}
+
+static uint8 **ring_rows(CFrame *frame, uint8 *ring, int nlines, int first)
+/* Build a row table that maps row y >= first of the frame to line      */
+/* (y-first) % nlines of a ring of full padded rows in the OCM. Release */
+/* it with release_memory(rows-pad).                                    */
+{
+    uint8 **rows;
+    int   row;
+
+    rows = get_memory("ring_rows",
+                      (frame->height + 2*frame->pad)*sizeof(uint8 *));
+    rows += frame->pad;
+    for (row = first; row < frame->height + frame->pad; row++)
+    {
+        rows[row] = ring + ((row-first) % nlines)*frame->stride + frame->pad;
+    }
+    return rows;
+}
+
+static void fetch_rows(Prefetch *p, uint8 **rows, CFrame *frame, int row)
+/* Start the DMA of the MSTEP padded rows from row into their ring lines. */
+/* The lines of a group of MSTEP rows are contiguous in the ring.         */
+{
+    prefetch_start(p, rows[row] - frame->pad,
+                   frame->pix + row*frame->stride - frame->pad,
+                   MSTEP*frame->stride);
+}
+
+int prefetch_search(MVector *mv, CFrame *prev, CFrame *curr)
+/* Same as full_search(), but the rows of both frames are copied by DMA  */
+/* into rings of full padded rows in the OCM. While a block row is being */
+/* searched, the MSTEP reference rows and the MSTEP current rows that    */
+/* the next block row adds are prefetched into the ring lines that the   */
+/* previous block row no longer needs. Returns 1, without searching, if  */
+/* the rings do not fit in the free OCM.                                 */
+{
+    Prefetch pp, cp;
+    uint8  *ring, **prev_rows, **curr_rows;
+    uint32 size, mark;
+    int    idy, ny, y;
+
+    size = (PREV_LINES + CURR_LINES)*curr->stride;
+    mark = arena_mark(&ocm_arena);
+    if (size > ocm_arena.size - mark)
+    {
+        return 1;
+    }
+    ny = curr->height/MSTEP;
+    ring = ocm_alloc("prefetch rings", size);
+    prev_rows = ring_rows(prev, ring, PREV_LINES, -SRANGE);
+    curr_rows = ring_rows(curr, ring + PREV_LINES*prev->stride, CURR_LINES, 0);
+    prefetch_open(&pp, 0);
+    prefetch_open(&cp, 1);
+
+    /* Fetch the rows of the first block row. */
+    for (y = -SRANGE; y < BSIZE + SRANGE; y += MSTEP)
+    {
+        fetch_rows(&pp, prev_rows, prev, y);
+        if (y >= 0 && y < BSIZE)
+        {
+            fetch_rows(&cp, curr_rows, curr, y);
+        }
+        prefetch_wait(&pp);
+        prefetch_wait(&cp);
+    }
+
+    for (idy = 0; idy < ny; idy++)
+    {
+        y = idy*MSTEP;
+        if (idy+1 < ny)
+        {
+            fetch_rows(&pp, prev_rows, prev, y + BSIZE + SRANGE);
+            fetch_rows(&cp, curr_rows, curr, y + BSIZE);
+        }
+        search_block_row(mv, prev_rows, curr_rows, curr->width, idy);
+        prefetch_wait(&pp);
+        prefetch_wait(&cp);
+    }
+
+    release_memory(prev_rows - prev->pad);
+    arena_release(&ocm_arena, mark);
+    return 0;
+}
+
+static void shift_window(uint8 **rows, int first, int nrows, int from,
+                         int to, int count)
+/* Move the count columns of the lines rows[first .. first+nrows-1]    */
+/* that start at column from to column to.                             */
+{
+    int y;
+
+    for (y = first; y < first+nrows; y++)
+    {
+        memmove(rows[y] + to, rows[y] + from, count);
+    }
+}
+
+static void gather_window(uint8 **rows, int first, int nrows, TFrame *frame,
+                          int x, int y, int col, int count)
+/* Copy count pixels of the nrows rows of the frame from (x, y) on into */
+/* the lines rows[first ..] at column col.                              */
+{
+    int i;
+
+    for (i = 0; i < nrows; i++)
+    {
+        get_tframe_row(frame, x, y+i, rows[first+i] + col, count);
+    }
+}
+
+void full_search_tiled(MVector *mv, TFrame *prev, TFrame *curr)
+/* Same as full_search() on tiled frames. The search windows of a block */
+/* row are gathered from the tiles into lines of SLIDE_WIDTH pixels and */
+/* the current blocks into a second set of lines, which are then        */
+/* searched with the row-table kernels. Moving one block to the right   */
+/* only gathers the MSTEP new columns of the window; when the lines are */
+/* full, the columns still needed move back to their start. Column 0 of */
+/* the lines is column base of the frames.                              */
+{
+    uint8 *win, *prev_rows[WSIZE], *curr_rows[WSIZE];
+    int   idx, idy, nx, ny, mvx, mvy, y, posx, posy;
+    int   base, prev_next, curr_next, end;
+
+    nx = curr->width/MSTEP;
+    ny = curr->height/MSTEP;
+    win = get_memory("full_search_tiled", (WSIZE + BSIZE)*SLIDE_WIDTH);
+    memset(curr_rows, 0, sizeof(curr_rows));
+    for (y = 0; y < WSIZE; y++)
+    {
+        prev_rows[y] = win + y*SLIDE_WIDTH;
+    }
+    for (y = 0; y < BSIZE; y++)
+    {
+        curr_rows[SRANGE+y] = win + (WSIZE + y)*SLIDE_WIDTH;
+    }
+    for (idy = 0; idy < ny; idy++)
+    {
+        posy = idy*MSTEP;
+        base = prev_next = -SRANGE;
+        curr_next = 0;
+        for (idx = 0; idx < nx; idx++)
+        {
+            posx = idx*MSTEP;
+            if (posx - SRANGE + WSIZE - base > SLIDE_WIDTH)
+            {
+                shift_window(prev_rows, 0, WSIZE, posx - SRANGE - base, 0,
+                             prev_next - (posx - SRANGE));
+                if (curr_next > posx)
+                {
+                    shift_window(curr_rows, SRANGE, BSIZE, posx - base,
+                                 SRANGE, curr_next - posx);
+                }
+                base = posx - SRANGE;
+            }
+            end = posx - SRANGE + WSIZE;
+            gather_window(prev_rows, 0, WSIZE, prev, prev_next, posy-SRANGE,
+                          prev_next - base, end - prev_next);
+            prev_next = end;
+            end = posx + BSIZE;
+            gather_window(curr_rows, SRANGE, BSIZE, curr, curr_next, posy,
+                          curr_next - base, end - curr_next);
+            curr_next = end;
+            (void) match(&mvx, &mvy, posx - base, SRANGE, prev_rows,
+                         curr_rows);
+            mv[idy*nx+idx].x = mvx, mv[idy*nx+idx].y = mvy;
+        }
+    }
+    release_memory(win);
+}
+
+static void open_stream(RowStream *s, CFrame *src, PnmReader *file,
+                        int nrows, int filter)
+/* Open a stream over the frame src or, if src is NULL, over the file. */
+{
+    int row;
+
+    memset(s, 0, sizeof(RowStream));
+    s->src = src, s->file = file;
+    s->nrows = nrows;
+    s->filter = filter;
+    if (src != NULL)
+    {
+        s->width = src->width, s->height = src->height;
+        s->stride = src->stride, s->pad = src->pad;
+    }
+    else
+    {
+        s->width = file->width, s->height = file->height;
+        s->pad = (FRAME_PAD + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+        s->stride = (s->width + 2*s->pad + FRAME_ALIGN-1) & ~(FRAME_ALIGN-1);
+    }
+    s->table = get_memory("stream rows",
+                          (s->height + 2*s->pad)*sizeof(uint8 *));
+    s->rows = s->table + s->pad;
+    if (src != NULL && !filter)
+    {
+        /* Nothing to filter: read straight from the source frame. */
+        for (row = -s->pad; row < s->height + s->pad; row++)
+        {
+            s->rows[row] = src->pix + row*src->stride;
+        }
+        s->next = s->height;
+        return;
+    }
+    s->ring = get_memory("stream ring", nrows*s->stride);
+    s->buf = get_memory("stream buf", 3*s->width);
+    if (file != NULL)
+    {
+        s->raw = get_memory("stream raw", 3*s->width);
+    }
+}
+
+static void close_stream(RowStream *s)
+/* Release the buffers of the stream and of the streams opened after it. */
+{
+    release_memory(s->table);
+}
+
+static uint8 *source_row(RowStream *s, int row)
+/* Return the unfiltered row of the source. A file is read up to the    */
+/* row, and only the rows row-2 .. row are kept.                        */
+{
+    if (s->file == NULL)
+    {
+        return s->src->pix + row*s->src->stride;
+    }
+    while (s->file->next <= row)
+    {
+        if (read_pnm_rows(s->file, s->raw + (s->file->next % 3)*s->width,
+                          s->width, 1))
+        {
+            s->error = 1;
+            break;
+        }
+    }
+    return s->raw + (row % 3)*s->width;
+}
+
+static void advance_stream(RowStream *s, int end)
+/* Filter the rows up to (excluding) row end into the ring buffer. The   */
+/* border rows above row 0 and below the last row map to the ring lines  */
+/* of those rows.                                                        */
+{
+    uint8 *dst, *below;
+    int   row;
+
+    if (end > s->height)
+    {
+        end = s->height;
+    }
+    for (; s->next < end; s->next++)
+    {
+        dst = s->ring + (s->next % s->nrows)*s->stride + s->pad;
+        if (!s->filter || s->next == 0 || s->next == s->height-1)
+        {
+            memcpy(dst, source_row(s, s->next), s->width);
+        }
+        else
+        {
+            /* Fetch the row below first, a file is read in order. */
+            below = source_row(s, s->next+1);
+            median3x3_row(dst, source_row(s, s->next-1),
+                          source_row(s, s->next), below, s->buf, s->width);
+        }
+        memset(dst - s->pad, dst[0], s->pad);
+        memset(dst + s->width, dst[s->width-1],
+               s->stride - s->width - s->pad);
+        s->rows[s->next] = dst;
+        if (s->next == 0)
+        {
+            for (row = -s->pad; row < 0; row++)
+            {
+                s->rows[row] = dst;
+            }
+        }
+        if (s->next == s->height-1)
+        {
+            for (row = s->height; row < s->height + s->pad; row++)
+            {
+                s->rows[row] = dst;
+            }
+        }
+    }
+}
+
+void stream_search(MVector *mv, CFrame *prev, CFrame *curr,
+                   int filter_prev, int filter_curr)
+/* Same as median filtering both frames and calling full_search(), but   */
+/* the frames are median filtered row by row into small ring buffers just */
+/* ahead of the block row being searched. The filtered rows are consumed  */
+/* while they are still in the caches and the source frames are left      */
+/* unchanged. filter_prev and filter_curr select which frames to filter.  */
+{
+    RowStream ps, cs;
+    int idy, ny, y;
+
+    ny = curr->height/MSTEP;
+    open_stream(&ps, prev, NULL, PREV_ROWS, filter_prev);
+    open_stream(&cs, curr, NULL, CURR_ROWS, filter_curr);
+    for (idy = 0; idy < ny; idy++)
+    {
+        y = idy*MSTEP;
+        advance_stream(&ps, y + BSIZE + SRANGE - 1);
+        advance_stream(&cs, y + BSIZE);
+        search_block_row(mv, ps.rows, cs.rows, curr->width, idy);
+    }
+    close_stream(&ps);
+}
+
+int file_search(MVector *mv, PnmReader *prev, PnmReader *curr,
+                int filter_prev, int filter_curr)
+/* Same as stream_search(), but the frames are read from the files row   */
+/* by row as the search moves down. Only the window rows of the current  */
+/* block row are held in memory, so the memory used grows with the frame */
+/* width and not with its size. Returns 1 if a file could not be read.   */
+{
+    RowStream ps, cs;
+    int idy, ny, y, error;
+
+    ny = curr->height/MSTEP;
+    open_stream(&ps, NULL, prev, PREV_ROWS, filter_prev);
+    open_stream(&cs, NULL, curr, CURR_ROWS, filter_curr);
+    for (idy = 0; idy < ny && !ps.error && !cs.error; idy++)
+    {
+        y = idy*MSTEP;
+        advance_stream(&ps, y + BSIZE + SRANGE - 1);
+        advance_stream(&cs, y + BSIZE);
+        search_block_row(mv, ps.rows, cs.rows, curr->width, idy);
+    }
+    error = ps.error || cs.error;
+    close_stream(&ps);
+    return error;
+}
@@ -0,0 +1,60 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : motion.h                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Block-based full-search motion estimation.                             */
+/*                                                                         */
+/*  The search kernels address the frames through row tables: rows[y]     */
+/*  points to the first pixel of row y. A contiguous frame has a table of */
+/*  rows[y] = pix + y*width, while a frame streamed through a ring buffer */
+/*  only has valid entries for the rows currently held in the ring. Rows  */
+/*  and columns outside the frame are served by the replicated border of  */
+/*  a CFrame (or of the ring lines), so every block of the frame gets a   */
+/*  motion vector and the kernels need no bounds checks. Tiled frames     */
+/*  (TFrame) are searched through a window gathered from their tiles.     */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __MOTION_H__
+
+#include "image.h"
+
+#define BSIZE  16  /* Block size for motion estimation */
+#define MSTEP   8  /* Step size between motion vectors */
+#define SRANGE 16  /* Motion vectors range from -SRANGE to SRANGE-1 */
+
+/* Border needed around a CFrame so that the search windows of all the */
+/* blocks, including the ones on the right and bottom edges, stay      */
+/* within the padded frame.                                            */
+#define FRAME_PAD (SRANGE + BSIZE - MSTEP)
+
+/* Cache budget for the reference window of a vertical strip of blocks */
+/* in strip_search(), half of the 32KB L1 data cache of the A9. A strip */
+/* is STRIP_BLOCKS blocks wide and its window has 2*SRANGE+BSIZE rows.  */
+#define STRIP_CACHE  (16*1024)
+#define STRIP_BLOCKS ((STRIP_CACHE/(2*SRANGE + BSIZE) - 2*SRANGE - BSIZE) \
+                      / MSTEP + 1)
+
+typedef struct {
+    int8 x;
+    int8 y;
+} MVector;
+
+extern int ocm_scratch;
+extern int search_yields;
+
+void  full_search(MVector *mv, CFrame *prev, CFrame *curr);
+void  full_search_amp(MVector *mv, CFrame *prev, CFrame *curr);
+void  full_search_pool(MVector **mv, CFrame **prev, CFrame **curr, int count);
+uint32 full_search_pool_bytes(int count, CFrame *frame);
+int   prefetch_search(MVector *mv, CFrame *prev, CFrame *curr);
+long  strip_search(MVector *mv, CFrame *prev, CFrame *curr);
+void  full_search_tiled(MVector *mv, TFrame *prev, TFrame *curr);
+void  search_block_row(MVector *mv, uint8 **prev_rows, uint8 **curr_rows,
+                       int32 width, int idy);
+void  stream_search(MVector *mv, CFrame *prev, CFrame *curr,
+                    int filter_prev, int filter_curr);
+int   file_search(MVector *mv, PnmReader *prev, PnmReader *curr,
+                  int filter_prev, int filter_curr);
+
+#define __MOTION_H__
+#endif
@@ -0,0 +1,53 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : ocm.c                                                         */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The OCM scratchpad allocator.                                          */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "ocm.h"
+#include "region.h"
+
+#ifndef HOST_BUILD
+/* Bounds of the scratchpad, defined in lscript.ld. */
+extern uint8 _ocm_scratch_start[], _ocm_scratch_end[];
+#endif
+
+Arena ocm_arena = { "ocm", OCM_HOST_SIZE };
+
+void ocm_init(void)
+/* Point the OCM arena at the scratchpad section. On the host the arena */
+/* takes its memory from the heap on the first allocation instead.     */
+{
+#ifndef HOST_BUILD
+    arena_init(&ocm_arena, _ocm_scratch_start,
+               (uint32) (_ocm_scratch_end - _ocm_scratch_start));
+#else
+    arena_reset(&ocm_arena);
+#endif
+}
+
+void *ocm_alloc(const char *name, uint32 size)
+/* Allocate a cache-line aligned block from the scratchpad. Blocks are */
+/* freed with arena_release() on ocm_arena.                            */
+{
+    return arena_alloc(&ocm_arena, name, size, FRAME_ALIGN);
+}
+
+void ocm_share(void)
+/* Make the OCM section shareable, for the data both cores use (see */
+/* mailbox.h and fslock.h). The BSP maps it as shareable already,   */
+/* this makes them independent of the translation table.            */
+{
+#ifndef HOST_BUILD
+    static int shared;
+
+    if (!shared)
+    {
+        region_declare("ocm shared",
+                       (void *) ((uint32) ocm_arena.base & ~(SECTION_SIZE-1)),
+                       SECTION_SIZE, MEM_SHARED);
+        shared = 1;
+    }
+#endif
+}
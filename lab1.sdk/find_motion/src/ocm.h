@@ -0,0 +1,36 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : ocm.h                                                         */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The 192KB of low on-chip memory (OCM) at address 0, see lscript.ld.    */
+/*  It has a much lower latency than the DDR and is used as a scratchpad   */
+/*  for the hot data of the search: the reference window and the current  */
+/*  rows of strip_search(). ocm_arena hands it out like the other arenas  */
+/*  of arena.h. On the host (HOST_BUILD) it falls back to heap memory.    */
+/*                                                                         */
+/*  When OCM_KERNELS is defined, the functions marked OCM_TEXT are linked  */
+/*  into the OCM too. They are close enough to the DDR code for plain     */
+/*  branches, so no long calls are needed.                                 */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __OCM_H__
+
+#include "arena.h"
+
+#if defined(OCM_KERNELS) && !defined(HOST_BUILD)
+#define OCM_TEXT __attribute__((section(".ocm_text")))
+#else
+#define OCM_TEXT
+#endif
+
+/* Size of the scratchpad on the host. */
+#define OCM_HOST_SIZE (192*1024)
+
+extern Arena ocm_arena;
+
+void  ocm_init(void);
+void *ocm_alloc(const char *name, uint32 size);
+void  ocm_share(void);
+
+#define __OCM_H__
+#endif
@@ -0,0 +1,265 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : pipeline.c                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Frame slots and the two-stage pipeline of pipeline.h.                  */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "pipeline.h"
+#include "median.h"
+#include "amp.h"
+#include "task.h"
+
+#define SLOTS 3
+
+/* Defined in find_motion.c. */
+long get_usec_time();
+
+typedef struct
+{
+    FrameSlot *slot;
+    float     noise_ratio;
+    uint8     *buf;         /* median3x3_band() buffer                    */
+    int32     violations;
+    PipeMode  mode;
+    Task      *task;        /* the loader task of PIPE_TASKS              */
+    int       posted;       /* a load is waiting for the loader task      */
+    int       quit;
+} LoadJob;
+
+static int hand_over(FrameSlot *slot, FrameOwner from, FrameOwner to,
+                     int32 *violations)
+/* Pass the slot from its owner to the next stage. Returns 1 and leaves */
+/* the slot alone if it is not owned by from.                           */
+{
+    if (slot->owner != from)
+    {
+        (*violations)++;
+        return 1;
+    }
+    slot->owner = to;
+    return 0;
+}
+
+static void load_frame(void *arg, int first, int end)
+/* The loading stage, run on CPU1: read the file of the slot into its   */
+/* frame, then filter it if it is noisy and replicate its border.       */
+{
+    LoadJob   *job = arg;
+    FrameSlot *slot = job->slot;
+    CFrame    *f = &slot->frame;
+    PnmReader reader;
+    long      t = get_usec_time();
+
+    if (hand_over(slot, FRAME_FREE, FRAME_LOADING, &job->violations))
+    {
+        return;
+    }
+    slot->error = open_pnm_rows(slot->name, &reader);
+    if (!slot->error)
+    {
+        slot->error = reader.width != f->width || reader.height != f->height
+                      || read_pnm_rows(&reader, f->pix, f->stride, f->height);
+        close_pnm_rows(&reader);
+    }
+    if (!slot->error)
+    {
+        slot->noise = estimate_noise(f->pix, f->width, f->height, f->stride);
+        slot->filtered = slot->noise > job->noise_ratio;
+        if (slot->filtered && f->width >= 3 && f->height >= 3)
+        {
+            median3x3_band(f->pix, f->width, f->stride, 1, f->height-1,
+                           f->pix, f->pix + (f->height-1)*f->stride, job->buf);
+        }
+        pad_frame(f);
+    }
+    slot->usec = get_usec_time() - t;
+    hand_over(slot, FRAME_LOADING, FRAME_READY, &job->violations);
+}
+
+static void loader_task(void *arg)
+/* The loading stage of PIPE_TASKS, which loads the posted frames. */
+{
+    LoadJob *job = arg;
+
+    while (!job->quit)
+    {
+        if (job->posted)
+        {
+            load_frame(job, 0, 1);
+            job->posted = 0;
+        }
+        else
+        {
+            task_yield();
+        }
+    }
+}
+
+static void post_load(LoadJob *job, FrameSlot *slot, const char *pattern,
+                      int number)
+{
+    sprintf(slot->name, pattern, number);
+    job->slot = slot;
+    switch (job->mode)
+    {
+    case PIPE_CPU1:
+        amp_post(load_frame, job, 0, 1);
+        break;
+    case PIPE_TASKS:
+        job->posted = 1;
+        break;
+    default:
+        load_frame(job, 0, 1);
+        break;
+    }
+}
+
+static int wait_load(LoadJob *job, PipelineStats *stats)
+/* Wait for the posted load and take the slot over for the search. The */
+/* time of a task also counts the search run during the transfers, so  */
+/* its load time is taken from the scheduler instead.                  */
+{
+    if (job->mode == PIPE_CPU1)
+    {
+        amp_wait();
+    }
+    while (job->posted)
+    {
+        task_yield();
+    }
+    if (job->mode != PIPE_TASKS)
+    {
+        stats->load_usec += job->slot->usec;
+    }
+    if (job->slot->error)
+    {
+        return 1;
+    }
+    stats->frames++;
+    return hand_over(job->slot, FRAME_READY, FRAME_SEARCH, &stats->violations);
+}
+
+int run_pipeline(const char *pattern, int first, int count,
+                 float noise_ratio, PipeMode mode, PairFunc on_pair,
+                 PipelineStats *stats)
+/* Estimate the motion between the consecutive frames first .. first+  */
+/* count-1 of a sequence, whose file names are made from the printf    */
+/* pattern and the frame number. Stops at the first frame that cannot  */
+/* be read. Returns 1 if no pair could be searched.                    */
+{
+    FrameSlot slots[SLOTS], *prev, *curr;
+    LoadJob   job;
+    PnmReader reader;
+    MVector   *mv;
+    long      t0, t, loaded;
+    int       k, i;
+
+    memset(stats, 0, sizeof(PipelineStats));
+    memset(slots, 0, sizeof(slots));
+
+    /* All the frames have the size of the first one. */
+    sprintf(slots[0].name, pattern, first);
+    if (open_pnm_rows(slots[0].name, &reader))
+    {
+        printf("run_pipeline: cannot read '%s'.\n", slots[0].name);
+        return 1;
+    }
+    close_pnm_rows(&reader);
+    for (i = 0; i < SLOTS; i++)
+    {
+        alloc_frame(&slots[i].frame, reader.width, reader.height, FRAME_PAD);
+    }
+    mv = get_memory("mv", sizeof(MVector)*(reader.width/MSTEP)
+                          *(reader.height/MSTEP));
+    memset(&job, 0, sizeof(job));
+    job.noise_ratio = noise_ratio;
+    job.buf = get_memory("median3x3 buffers", 5*reader.width);
+    job.mode = (mode == PIPE_CPU1 && amp_cores < 2)? PIPE_SERIAL : mode;
+    if (job.mode == PIPE_TASKS)
+    {
+        job.task = task_create("loader", loader_task, &job);
+        job.mode = (job.task != NULL)? PIPE_TASKS : PIPE_SERIAL;
+        search_yields = (job.task != NULL);
+    }
+
+    t0 = get_usec_time();
+    post_load(&job, &slots[0], pattern, first);
+    if (!wait_load(&job, stats) && count > 1)
+    {
+        post_load(&job, &slots[1], pattern, first+1);
+    }
+    for (k = 1; k < count && stats->frames == k; k++)
+    {
+        prev = &slots[(k-1) % SLOTS];
+        curr = &slots[k % SLOTS];
+        if (wait_load(&job, stats))
+        {
+            break;
+        }
+
+        /* Load the next frame into the slot freed by the last pair. */
+        if (k+1 < count)
+        {
+            post_load(&job, &slots[(k+1) % SLOTS], pattern, first+k+1);
+        }
+
+        /* The loader task runs during the search of PIPE_TASKS. */
+        t = get_usec_time();
+        loaded = (job.task != NULL)? task_usec(job.task) : 0;
+        full_search(mv, &prev->frame, &curr->frame);
+        t = get_usec_time() - t;
+        stats->search_usec += t - ((job.task != NULL)?
+                                   task_usec(job.task) - loaded : 0);
+        stats->pairs++;
+        if (on_pair != NULL)
+        {
+            on_pair(mv, prev, curr, first+k);
+        }
+        hand_over(prev, FRAME_SEARCH, FRAME_FREE, &stats->violations);
+    }
+    if (job.mode == PIPE_CPU1)
+    {
+        amp_wait();
+    }
+    if (job.task != NULL)
+    {
+        job.quit = 1;
+        while (!task_done(job.task))
+        {
+            task_yield();
+        }
+        stats->load_usec = task_usec(job.task);
+        search_yields = 0;
+    }
+    stats->wall_usec = get_usec_time() - t0;
+    stats->violations += job.violations;
+
+    release_memory(mv);
+    for (i = SLOTS-1; i >= 0; i--)
+    {
+        free_frame(&slots[i].frame);
+    }
+    return stats->pairs == 0;
+}
+
+void report_pipeline(PipelineStats *stats)
+/* Print the busy time and the utilization of both stages. */
+{
+    long wall = (stats->wall_usec > 0)? stats->wall_usec : 1;
+
+    printf("Pipeline: %ld frames, %ld pairs in %ld ms, %.2f frames/s.\n",
+           (long) stats->frames, (long) stats->pairs, stats->wall_usec/1000,
+           stats->frames*1e6f/wall);
+    printf("  load+filter: %6ld ms busy, %5.1f%% utilization.\n",
+           stats->load_usec/1000, 100.0f*stats->load_usec/wall);
+    printf("  search     : %6ld ms busy, %5.1f%% utilization.\n",
+           stats->search_usec/1000, 100.0f*stats->search_usec/wall);
+    printf("  The stages run back to back would take %ld ms.\n",
+           (stats->load_usec + stats->search_usec)/1000);
+    if (stats->violations)
+    {
+        printf("  %ld frame hand-overs from the wrong owner!\n",
+               (long) stats->violations);
+    }
+}
@@ -0,0 +1,70 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : pipeline.h                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The two-core pipeline over a sequence of frames: while CPU0 searches  */
+/*  the pair (N-1, N), CPU1 reads frame N+1, estimates its noise and      */
+/*  median filters it. A sequence thus runs at the pace of the slower of  */
+/*  the two stages instead of their sum.                                  */
+/*                                                                         */
+/*  The frames live in a ring of three slots, each owned by one stage at  */
+/*  a time: FREE -> LOADING (CPU1) -> READY -> SEARCH (CPU0, as the       */
+/*  current and then the previous frame of a pair) -> FREE. A stage only  */
+/*  touches the slots it owns; a slot handed over from the wrong owner is */
+/*  counted as a violation in the statistics. CPU0 does not use FatFs     */
+/*  while the pipeline runs, so CPU1 has the SD card to itself.           */
+/*                                                                         */
+/*  On one core, the loading stage can run as a task (see task.h) instead */
+/*  of on CPU1: the search yields after every block and the loader yields */
+/*  while the SD card transfers data, so the transfers overlap the search.*/
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __PIPELINE_H__
+
+#include "image.h"
+#include "motion.h"
+
+typedef enum
+{
+    PIPE_SERIAL,          /* load, then search, on CPU0                   */
+    PIPE_CPU1,            /* load on CPU1                                 */
+    PIPE_TASKS            /* load in a task on CPU0                       */
+} PipeMode;
+
+typedef enum
+{
+    FRAME_FREE, FRAME_LOADING, FRAME_READY, FRAME_SEARCH
+} FrameOwner;
+
+typedef struct
+{
+    CFrame              frame;
+    volatile FrameOwner owner;
+    char   name[32];      /* file of the frame, formatted by CPU0        */
+    float  noise;
+    int    filtered;
+    int    error;         /* set by the loader if the file is unusable    */
+    long   usec;          /* time spent loading the frame                 */
+} FrameSlot;
+
+typedef struct
+{
+    int32 frames;         /* frames loaded                                */
+    int32 pairs;          /* pairs searched                               */
+    long  load_usec;      /* busy time of the loading stage               */
+    long  search_usec;    /* busy time of the search stage                */
+    long  wall_usec;
+    int32 violations;     /* hand-overs from the wrong owner              */
+} PipelineStats;
+
+/* Called on CPU0 with the vector field of the pair (number-1, number). */
+typedef void (*PairFunc)(MVector *mv, FrameSlot *prev, FrameSlot *curr,
+                         int number);
+
+int  run_pipeline(const char *pattern, int first, int count,
+                  float noise_ratio, PipeMode mode, PairFunc on_pair,
+                  PipelineStats *stats);
+void report_pipeline(PipelineStats *stats);
+
+#define __PIPELINE_H__
+#endif
@@ -0,0 +1,287 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : pool.c                                                        */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The work-stealing thread pool of pool.h.                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "pool.h"
+
+int pool_threads = 1;
+
+#ifdef HOST_BUILD
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+/* Chunks a deque holds. The chunks of a job that do not fit are run by */
+/* the caller.                                                          */
+#define POOL_DEQUE 256
+
+typedef struct
+{
+    atomic_int pending;     /* chunks of the job not done yet             */
+} Group;
+
+typedef struct
+{
+    AmpJob job;
+    void   *arg;
+    int    first, end;
+    Group  *group;
+} Chunk;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_t       thread;
+    int             top, bottom;  /* chunks[top .. bottom-1], modulo      */
+                                  /* POOL_DEQUE                           */
+    atomic_long     steals;       /* chunks stolen by this thread         */
+    Chunk           chunks[POOL_DEQUE];
+} Worker;
+
+static Worker workers[POOL_MAX_THREADS];
+static int    started;
+
+/* Index of the calling thread in workers[], 0 for the main thread. */
+static _Thread_local int self;
+
+/* Idle threads sleep until the work count changes. */
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  idle_cond = PTHREAD_COND_INITIALIZER;
+static long            work_count;
+static int             quit;
+
+static int take(Chunk *chunk)
+/* Pop the newest chunk of the own deque, or else steal the oldest chunk */
+/* of the next thread that has one. Returns 0 if all deques are empty.  */
+{
+    Worker *w;
+    int i;
+
+    for (i = 0; i < pool_threads; i++)
+    {
+        w = &workers[(self + i) % pool_threads];
+        pthread_mutex_lock(&w->lock);
+        if (w->top != w->bottom)
+        {
+            if (i == 0)
+            {
+                *chunk = w->chunks[--w->bottom % POOL_DEQUE];
+            }
+            else
+            {
+                *chunk = w->chunks[w->top++ % POOL_DEQUE];
+                atomic_fetch_add(&workers[self].steals, 1);
+            }
+            if (w->top == w->bottom)
+            {
+                w->top = w->bottom = 0;
+            }
+            pthread_mutex_unlock(&w->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+    return 0;
+}
+
+static void run_chunk(Chunk *chunk)
+{
+    chunk->job(chunk->arg, chunk->first, chunk->end);
+    atomic_fetch_sub_explicit(&chunk->group->pending, 1, memory_order_release);
+}
+
+static void *pool_main(void *arg)
+/* The loop of a pool thread. */
+{
+    Chunk chunk;
+    long  seen;
+
+    self = (int) (size_t) arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&idle_lock);
+        seen = work_count;
+        if (quit)
+        {
+            pthread_mutex_unlock(&idle_lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&idle_lock);
+
+        while (take(&chunk))
+        {
+            run_chunk(&chunk);
+        }
+
+        pthread_mutex_lock(&idle_lock);
+        while (work_count == seen && !quit)
+        {
+            pthread_cond_wait(&idle_cond, &idle_lock);
+        }
+        pthread_mutex_unlock(&idle_lock);
+    }
+}
+
+int pool_init(int threads)
+/* Start a pool of threads threads, the caller included, or of one     */
+/* thread per CPU if threads is 0. A running pool is stopped first.    */
+/* Returns the number of threads, 1 if no thread could be started.     */
+{
+    int i;
+
+    pool_exit();
+    if (threads <= 0)
+    {
+        threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    threads = (threads < 1)? 1 : (threads > POOL_MAX_THREADS)?
+              POOL_MAX_THREADS : threads;
+    for (i = 0; i < threads; i++)
+    {
+        pthread_mutex_init(&workers[i].lock, NULL);
+        workers[i].top = workers[i].bottom = 0;
+        atomic_init(&workers[i].steals, 0);
+    }
+    self = 0;
+    quit = 0;
+    pool_threads = threads;
+    for (started = 1; started < threads; started++)
+    {
+        if (pthread_create(&workers[started].thread, NULL, pool_main,
+                           (void *) (size_t) started))
+        {
+            printf("pool_init: cannot start thread %d.\n", started);
+            pool_exit();
+            break;
+        }
+    }
+    return pool_threads;
+}
+
+void pool_exit(void)
+/* Stop the threads of the pool. */
+{
+    int i;
+
+    if (started == 0)
+    {
+        return;
+    }
+    pthread_mutex_lock(&idle_lock);
+    quit = 1;
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+    for (i = 1; i < started; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    for (i = 0; i < pool_threads; i++)
+    {
+        pthread_mutex_destroy(&workers[i].lock);
+    }
+    started = 0;
+    pool_threads = 1;
+}
+
+void pool_run(AmpJob job, void *arg, int count)
+/* Run the items 0 .. count-1 of a job with all the threads of the pool */
+/* and return once they are done.                                       */
+{
+    Worker *w = &workers[self];
+    Group  group;
+    Chunk  chunk;
+    int    size, first;
+
+    if (pool_threads < 2 || count < 2)
+    {
+        job(arg, 0, count);
+        return;
+    }
+    size = (count + pool_threads*POOL_SPLIT-1)/(pool_threads*POOL_SPLIT);
+    atomic_init(&group.pending, (count + size-1)/size);
+    chunk.job = job, chunk.arg = arg, chunk.group = &group;
+
+    pthread_mutex_lock(&w->lock);
+    for (first = 0; first < count && w->bottom - w->top < POOL_DEQUE;
+         first += size)
+    {
+        chunk.first = first;
+        chunk.end = (first + size < count)? first + size : count;
+        w->chunks[w->bottom++ % POOL_DEQUE] = chunk;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    pthread_mutex_lock(&idle_lock);
+    work_count++;
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+
+    for (; first < count; first += size)
+    {
+        chunk.first = first;
+        chunk.end = (first + size < count)? first + size : count;
+        run_chunk(&chunk);
+    }
+
+    /* Help with any chunk, of this job or not, until this job is done. */
+    while (atomic_load_explicit(&group.pending, memory_order_acquire) > 0)
+    {
+        if (take(&chunk))
+        {
+            run_chunk(&chunk);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+}
+
+int pool_self(void)
+/* Index of the calling thread, 0 .. pool_threads-1, with 0 for the one */
+/* that called pool_init(). A job may use it to pick a scratch buffer. */
+{
+    return self;
+}
+
+long pool_steals(void)
+/* Chunks stolen since pool_init(). */
+{
+    long steals = 0;
+    int  i;
+
+    for (i = 0; i < pool_threads; i++)
+    {
+        steals += atomic_load(&workers[i].steals);
+    }
+    return steals;
+}
+#else
+int pool_init(int threads)
+{
+    return pool_threads = 1;
+}
+
+void pool_exit(void)
+{
+}
+
+void pool_run(AmpJob job, void *arg, int count)
+{
+    job(arg, 0, count);
+}
+
+int pool_self(void)
+{
+    return 0;
+}
+
+long pool_steals(void)
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,40 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : pool.h                                                        */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Work-stealing thread pool of the host build. pool_run() cuts a job    */
+/*  (see amp.h) into chunks of items, pushes them on the deque of the     */
+/*  calling thread and runs them with the other threads of the pool: a    */
+/*  thread takes the newest chunk of its own deque and, once it is empty, */
+/*  steals the oldest chunk of another thread. The caller helps until     */
+/*  all its chunks are done, so a job may call pool_run() again.          */
+/*                                                                         */
+/*  Every item is run exactly once and the jobs only write the results   */
+/*  of their own items, so the output does not depend on the number of   */
+/*  threads or on which thread ran which chunk. On the target the pool   */
+/*  has one thread and pool_run() runs the job in the caller; the two    */
+/*  A9 cores are shared out with amp.h instead.                           */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __POOL_H__
+
+#include "amp.h"
+
+/* Largest number of threads of the pool, the caller included. */
+#define POOL_MAX_THREADS 256
+
+/* Chunks per thread of a job, so that the threads can even out the    */
+/* load by stealing.                                                    */
+#define POOL_SPLIT 4
+
+/* Threads of the pool, the caller included; 1 until pool_init(). */
+extern int pool_threads;
+
+int  pool_init(int threads);
+void pool_exit(void);
+void pool_run(AmpJob job, void *arg, int count);
+int  pool_self(void);
+long pool_steals(void);
+
+#define __POOL_H__
+#endif
@@ -0,0 +1,124 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : prefetch.c                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  DMA prefetch into the OCM. The DMA controller and the interrupt setup  */
+/*  follow the interrupt example of the dmaps driver.                      */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "prefetch.h"
+#include "gic.h"
+
+#ifndef HOST_BUILD
+#include "xparameters.h"
+#include "xil_cache.h"
+
+static XDmaPs dma;
+
+static void prefetch_done(unsigned int channel, XDmaPs_Cmd *cmd, void *ref)
+{
+    ((Prefetch *) ref)->busy = 0;
+}
+
+int prefetch_init(void)
+/* Initialize the DMA controller and route its interrupts of channels */
+/* 0 and 1 to the CPU through the shared GIC (gic.h), which must be   */
+/* initialized. Returns 0 on success.                                 */
+{
+    XDmaPs_Config *dma_cfg;
+
+    dma_cfg = XDmaPs_LookupConfig(XPAR_XDMAPS_0_DEVICE_ID);
+    if (dma_cfg == NULL || gic.IsReady != XIL_COMPONENT_IS_READY
+        || XDmaPs_CfgInitialize(&dma, dma_cfg, dma_cfg->BaseAddress))
+    {
+        printf("prefetch_init: cannot initialize the DMA controller.\n");
+        return 1;
+    }
+
+    XScuGic_Connect(&gic, XPAR_XDMAPS_0_FAULT_INTR,
+        (Xil_InterruptHandler) XDmaPs_FaultISR, &dma);
+    XScuGic_Connect(&gic, XPAR_XDMAPS_0_DONE_INTR_0,
+        (Xil_InterruptHandler) XDmaPs_DoneISR_0, &dma);
+    XScuGic_Connect(&gic, XPAR_XDMAPS_0_DONE_INTR_1,
+        (Xil_InterruptHandler) XDmaPs_DoneISR_1, &dma);
+    XScuGic_Enable(&gic, XPAR_XDMAPS_0_FAULT_INTR);
+    XScuGic_Enable(&gic, XPAR_XDMAPS_0_DONE_INTR_0);
+    XScuGic_Enable(&gic, XPAR_XDMAPS_0_DONE_INTR_1);
+    return 0;
+}
+
+void prefetch_open(Prefetch *p, unsigned int channel)
+/* Bind p to a DMA channel. The transfers use 8-byte bursts of 16 beats, */
+/* the largest the controller supports.                                  */
+{
+    memset(p, 0, sizeof(Prefetch));
+    p->channel = channel;
+    p->cmd.ChanCtrl.SrcBurstSize = 8;
+    p->cmd.ChanCtrl.SrcBurstLen = 16;
+    p->cmd.ChanCtrl.SrcInc = 1;
+    p->cmd.ChanCtrl.DstBurstSize = 8;
+    p->cmd.ChanCtrl.DstBurstLen = 16;
+    p->cmd.ChanCtrl.DstInc = 1;
+    XDmaPs_SetDoneHandler(&dma, channel, prefetch_done, p);
+}
+
+void prefetch_start(Prefetch *p, uint8 *dst, uint8 *src, uint32 len)
+/* Start copying len bytes from src to dst. Both must be 8-byte aligned. */
+{
+    prefetch_wait(p);
+    Xil_DCacheFlushRange((INTPTR) src, len);
+
+    /* Write back and drop the lines of dst too: a dirty line left by the */
+    /* CPU would otherwise be evicted later, over the data of the DMA.    */
+    Xil_DCacheFlushRange((INTPTR) dst, len);
+    p->dst = dst, p->len = len;
+    p->cmd.BD.SrcAddr = (u32) src;
+    p->cmd.BD.DstAddr = (u32) dst;
+    p->cmd.BD.Length = len;
+    p->busy = 1;
+    if (XDmaPs_Start(&dma, p->channel, &p->cmd, 0) != XST_SUCCESS)
+    {
+        /* The channel is not available: copy with the CPU instead. The */
+        /* copy is in the cache, which prefetch_wait() must not drop.   */
+        p->busy = 0;
+        p->dst = NULL;
+        memcpy(dst, src, len);
+    }
+}
+
+void prefetch_wait(Prefetch *p)
+/* Wait for the copy in flight, if any, to complete. */
+{
+    if (p->dst == NULL)
+    {
+        return;
+    }
+    while (p->busy)
+        ;
+    Xil_DCacheInvalidateRange((INTPTR) p->dst, p->len);
+    p->dst = NULL;
+}
+
+#else
+
+int prefetch_init(void)
+{
+    return 0;
+}
+
+void prefetch_open(Prefetch *p, unsigned int channel)
+{
+    memset(p, 0, sizeof(Prefetch));
+    p->channel = channel;
+}
+
+void prefetch_start(Prefetch *p, uint8 *dst, uint8 *src, uint32 len)
+{
+    memcpy(dst, src, len);
+}
+
+void prefetch_wait(Prefetch *p)
+{
+}
+
+#endif
@@ -0,0 +1,43 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : prefetch.h                                                    */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Background copies of frame rows into the OCM with the PL330 DMA        */
+/*  controller of the PS (XDmaPs). Each Prefetch owns one DMA channel and */
+/*  has at most one copy in flight:                                        */
+/*                                                                         */
+/*      prefetch_start() cleans the source range from the data caches and */
+/*                       starts the copy;                                  */
+/*      prefetch_wait()  waits for the done interrupt and invalidates the */
+/*                       destination range, so the CPU reads what the DMA */
+/*                       wrote and not stale cache lines.                 */
+/*                                                                         */
+/*  On the host (HOST_BUILD) prefetch_start() is a plain memcpy().        */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __PREFETCH_H__
+
+#include "image.h"
+
+#ifndef HOST_BUILD
+#include "xdmaps.h"
+#endif
+
+typedef struct
+{
+    unsigned int channel;
+    volatile int busy;
+    uint8        *dst;
+    uint32       len;
+#ifndef HOST_BUILD
+    XDmaPs_Cmd   cmd;
+#endif
+} Prefetch;
+
+int  prefetch_init(void);
+void prefetch_open(Prefetch *p, unsigned int channel);
+void prefetch_start(Prefetch *p, uint8 *dst, uint8 *src, uint32 len);
+void prefetch_wait(Prefetch *p);
+
+#define __PREFETCH_H__
+#endif
@@ -0,0 +1,326 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : prefilter.c                                                   */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Prefilter kernels. Besides the median filters of median.c there are    */
+/*  fixed-point separable Gaussian and box filters and a pseudo-median.    */
+/*                                                                         */
+/*  The separable filters run a horizontal pass per input row into a ring  */
+/*  of 16-bit lines and a vertical pass over the ring per output row. An   */
+/*  input row is consumed by the horizontal pass before the output row at  */
+/*  the same position is written, so the filters work in place.            */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "prefilter.h"
+#include "median.h"
+#include "simd.h"
+
+#define MIN(a, b) ((a) < (b)? (a) : (b))
+#define MAX(a, b) ((a) > (b)? (a) : (b))
+#define MED3(vmin, vmax, a, b, c) vmax(vmin(a, b), vmin(vmax(a, b), c))
+
+/* (sum+4) * BOX_SCALE >> 16 is the rounded sum/9 for 0 <= sum <= 2295. */
+#define BOX_SCALE 7282
+
+typedef void (*HorizontalPass)(uint16 *dst, uint8 *src, int width);
+typedef void (*VerticalPass)(uint8 *dst, uint16 **rows, int width);
+
+#if VLEN > 1
+static vu16 tap121(vu16 a, vu16 b, vu16 c)
+{
+    return vu16_add(vu16_add(a, c), vu16_shl(b, 1));
+}
+
+static vu16 tap111(vu16 a, vu16 b, vu16 c)
+{
+    return vu16_add(vu16_add(a, b), c);
+}
+
+static vu16 tap14641(vu16 a, vu16 b, vu16 c, vu16 d, vu16 e)
+{
+    return vu16_add(vu16_add(vu16_add(a, e), vu16_shl(vu16_add(b, d), 2)),
+                    vu16_add(vu16_shl(c, 2), vu16_shl(c, 1)));
+}
+#endif
+
+/* ----------------------------------------------------------------------- */
+/*  Horizontal passes: dst[x] for radius <= x < width-radius.             */
+/* ----------------------------------------------------------------------- */
+
+static void gauss3_h(uint16 *dst, uint8 *src, int width)
+{
+    int x = 1;
+#if VLEN > 1
+    vu8 a, b, c;
+
+    for (; x+VLEN <= width-1; x += VLEN)
+    {
+        a = vu8_load(src+x-1), b = vu8_load(src+x), c = vu8_load(src+x+1);
+        vu16_store(dst+x, tap121(vu16_lo(a), vu16_lo(b), vu16_lo(c)));
+        vu16_store(dst+x+VLEN/2, tap121(vu16_hi(a), vu16_hi(b), vu16_hi(c)));
+    }
+#endif
+    for (; x < width-1; x++)
+    {
+        dst[x] = src[x-1] + 2*src[x] + src[x+1];
+    }
+}
+
+static void gauss5_h(uint16 *dst, uint8 *src, int width)
+{
+    int x = 2;
+#if VLEN > 1
+    vu8 a, b, c, d, e;
+
+    for (; x+VLEN <= width-2; x += VLEN)
+    {
+        a = vu8_load(src+x-2), b = vu8_load(src+x-1), c = vu8_load(src+x);
+        d = vu8_load(src+x+1), e = vu8_load(src+x+2);
+        vu16_store(dst+x, tap14641(vu16_lo(a), vu16_lo(b), vu16_lo(c),
+                                   vu16_lo(d), vu16_lo(e)));
+        vu16_store(dst+x+VLEN/2, tap14641(vu16_hi(a), vu16_hi(b), vu16_hi(c),
+                                          vu16_hi(d), vu16_hi(e)));
+    }
+#endif
+    for (; x < width-2; x++)
+    {
+        dst[x] = src[x-2] + 4*src[x-1] + 6*src[x] + 4*src[x+1] + src[x+2];
+    }
+}
+
+static void box3_h(uint16 *dst, uint8 *src, int width)
+{
+    int x = 1;
+#if VLEN > 1
+    vu8 a, b, c;
+
+    for (; x+VLEN <= width-1; x += VLEN)
+    {
+        a = vu8_load(src+x-1), b = vu8_load(src+x), c = vu8_load(src+x+1);
+        vu16_store(dst+x, tap111(vu16_lo(a), vu16_lo(b), vu16_lo(c)));
+        vu16_store(dst+x+VLEN/2, tap111(vu16_hi(a), vu16_hi(b), vu16_hi(c)));
+    }
+#endif
+    for (; x < width-1; x++)
+    {
+        dst[x] = src[x-1] + src[x] + src[x+1];
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+/*  Vertical passes: rows[] holds the 2*radius+1 horizontal results.      */
+/* ----------------------------------------------------------------------- */
+
+static void gauss3_v(uint8 *dst, uint16 **rows, int width)
+{
+    int x = 1;
+#if VLEN > 1
+    vu16 lo, hi, round = vu16_set(8);
+
+    for (; x+VLEN <= width-1; x += VLEN)
+    {
+        lo = tap121(vu16_load(rows[0]+x), vu16_load(rows[1]+x),
+                    vu16_load(rows[2]+x));
+        hi = tap121(vu16_load(rows[0]+x+VLEN/2), vu16_load(rows[1]+x+VLEN/2),
+                    vu16_load(rows[2]+x+VLEN/2));
+        vu8_store(dst+x, vu16_pack(vu16_shr(vu16_add(lo, round), 4),
+                                   vu16_shr(vu16_add(hi, round), 4)));
+    }
+#endif
+    for (; x < width-1; x++)
+    {
+        dst[x] = (rows[0][x] + 2*rows[1][x] + rows[2][x] + 8) >> 4;
+    }
+}
+
+static void gauss5_v(uint8 *dst, uint16 **rows, int width)
+{
+    int x = 2;
+#if VLEN > 1
+    vu16 lo, hi, round = vu16_set(128);
+    int  h = VLEN/2;
+
+    for (; x+VLEN <= width-2; x += VLEN)
+    {
+        lo = tap14641(vu16_load(rows[0]+x), vu16_load(rows[1]+x),
+                      vu16_load(rows[2]+x), vu16_load(rows[3]+x),
+                      vu16_load(rows[4]+x));
+        hi = tap14641(vu16_load(rows[0]+x+h), vu16_load(rows[1]+x+h),
+                      vu16_load(rows[2]+x+h), vu16_load(rows[3]+x+h),
+                      vu16_load(rows[4]+x+h));
+        vu8_store(dst+x, vu16_pack(vu16_shr(vu16_add(lo, round), 8),
+                                   vu16_shr(vu16_add(hi, round), 8)));
+    }
+#endif
+    for (; x < width-2; x++)
+    {
+        dst[x] = (rows[0][x] + 4*rows[1][x] + 6*rows[2][x] + 4*rows[3][x]
+                  + rows[4][x] + 128) >> 8;
+    }
+}
+
+static void box3_v(uint8 *dst, uint16 **rows, int width)
+{
+    int x = 1;
+#if VLEN > 1
+    vu16 lo, hi, round = vu16_set(4);
+
+    for (; x+VLEN <= width-1; x += VLEN)
+    {
+        lo = tap111(vu16_load(rows[0]+x), vu16_load(rows[1]+x),
+                    vu16_load(rows[2]+x));
+        hi = tap111(vu16_load(rows[0]+x+VLEN/2), vu16_load(rows[1]+x+VLEN/2),
+                    vu16_load(rows[2]+x+VLEN/2));
+        vu8_store(dst+x, vu16_pack(vu16_mulhi(vu16_add(lo, round), BOX_SCALE),
+                                   vu16_mulhi(vu16_add(hi, round), BOX_SCALE)));
+    }
+#endif
+    for (; x < width-1; x++)
+    {
+        dst[x] = ((rows[0][x] + rows[1][x] + rows[2][x] + 4) * BOX_SCALE) >> 16;
+    }
+}
+
+static void separable(uint8 *image, int width, int height, int stride,
+                      int radius, HorizontalPass hpass, VerticalPass vpass)
+/* Run a separable filter with 2*radius+1 taps (radius <= 2). */
+{
+    uint16 *buf, *ring[5], *rows[5];
+    int    size, row, i;
+
+    size = 2*radius+1;
+    if (width < size || height < size)
+    {
+        return;
+    }
+    buf = get_memory("prefilter lines", size*width*sizeof(uint16));
+    for (i = 0; i < size; i++)
+    {
+        ring[i] = buf + i*width;
+    }
+
+    for (row = 0; row < size-1; row++)
+    {
+        hpass(ring[row], image + row*stride, width);
+    }
+    for (row = radius; row < height-radius; row++)
+    {
+        hpass(ring[(row+radius) % size], image + (row+radius)*stride, width);
+        for (i = 0; i < size; i++)
+        {
+            rows[i] = ring[(row-radius+i) % size];
+        }
+        vpass(image + row*stride, rows, width);
+    }
+    release_memory(buf);
+}
+
+static void med3_h(uint8 *dst, uint8 *src, int width)
+/* dst[x] = median of src[x-1..x+1], for 1 <= x < width-1. */
+{
+    int x = 1;
+#if VLEN > 1
+    for (; x+VLEN <= width-1; x += VLEN)
+    {
+        vu8_store(dst+x, MED3(vu8_min, vu8_max, vu8_load(src+x-1),
+                              vu8_load(src+x), vu8_load(src+x+1)));
+    }
+#endif
+    for (; x < width-1; x++)
+    {
+        dst[x] = MED3(MIN, MAX, src[x-1], src[x], src[x+1]);
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+/*  The prefilter kernels.                                                 */
+/* ----------------------------------------------------------------------- */
+
+static void no_filter(uint8 *image, int width, int height, int stride)
+{
+}
+
+static void median5x5(uint8 *image, int width, int height, int stride)
+{
+    median_filter(image, width, height, stride, 2);
+}
+
+static void gauss3x3(uint8 *image, int width, int height, int stride)
+{
+    separable(image, width, height, stride, 1, gauss3_h, gauss3_v);
+}
+
+static void gauss5x5(uint8 *image, int width, int height, int stride)
+{
+    separable(image, width, height, stride, 2, gauss5_h, gauss5_v);
+}
+
+static void box3x3(uint8 *image, int width, int height, int stride)
+{
+    separable(image, width, height, stride, 1, box3_h, box3_v);
+}
+
+static void pseudo_median3x3(uint8 *image, int width, int height,
+                             int stride)
+/* Approximate the 3x3 median by the median of the three row medians.   */
+/* The row medians are kept in a ring of three lines, as for separable  */
+/* filters, so each is computed only once.                              */
+{
+    uint8 *buf, *ring[3], *r0, *r1, *r2;
+    int   row, x;
+
+    if (width < 3 || height < 3)
+    {
+        return;
+    }
+    buf = get_memory("prefilter lines", 3*width);
+    ring[0] = buf, ring[1] = buf+width, ring[2] = buf+2*width;
+    med3_h(ring[0], image, width);
+    med3_h(ring[1], image+stride, width);
+    for (row = 1; row < height-1; row++)
+    {
+        med3_h(ring[(row+1) % 3], image + (row+1)*stride, width);
+        r0 = ring[(row-1) % 3], r1 = ring[row % 3], r2 = ring[(row+1) % 3];
+        x = 1;
+#if VLEN > 1
+        for (; x+VLEN <= width-1; x += VLEN)
+        {
+            vu8_store(image + row*stride + x,
+                      MED3(vu8_min, vu8_max, vu8_load(r0+x), vu8_load(r1+x),
+                           vu8_load(r2+x)));
+        }
+#endif
+        for (; x < width-1; x++)
+        {
+            image[row*stride + x] = MED3(MIN, MAX, r0[x], r1[x], r2[x]);
+        }
+    }
+    release_memory(buf);
+}
+
+const Prefilter prefilters[] =
+{
+    { "none",    "no filtering",                      0, no_filter        },
+    { "median3", "3x3 median, min/max network",       1, median3x3        },
+    { "median5", "5x5 median, constant-time histogram", 2, median5x5      },
+    { "pmedian", "3x3 pseudo-median of row medians",  1, pseudo_median3x3 },
+    { "gauss3",  "3x3 Gaussian [1 2 1]/4 separable",  1, gauss3x3         },
+    { "gauss5",  "5x5 Gaussian [1 4 6 4 1]/16 separable", 2, gauss5x5     },
+    { "box3",    "3x3 box average",                   1, box3x3           },
+    { NULL,      NULL,                                0, NULL             }
+};
+
+const Prefilter *find_prefilter(const char *name)
+/* Look up a prefilter by name. Returns NULL if there is none. */
+{
+    const Prefilter *p;
+
+    for (p = prefilters; p->name != NULL; p++)
+    {
+        if (!strcmp(p->name, name))
+        {
+            return p;
+        }
+    }
+    return NULL;
+}
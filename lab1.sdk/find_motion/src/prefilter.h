@@ -0,0 +1,31 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : prefilter.h                                                   */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The noise-removal stage run on both frames before motion estimation.  */
+/*  Every kernel filters the image in place and leaves a border of        */
+/*  'radius' pixels untouched; row y of the image starts at image +       */
+/*  y*stride. The kernels are listed in prefilters[], which is            */
+/*  terminated by an entry with a NULL name.                              */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __PREFILTER_H__
+
+#include "image.h"
+
+typedef void (*PrefilterFunc)(uint8 *image, int width, int height, int stride);
+
+typedef struct
+{
+    const char    *name;         /* name used to select the kernel      */
+    const char    *description;
+    int           radius;        /* the kernel is (2*radius+1) wide     */
+    PrefilterFunc run;
+} Prefilter;
+
+extern const Prefilter prefilters[];
+
+const Prefilter *find_prefilter(const char *name);
+
+#define __PREFILTER_H__
+#endif
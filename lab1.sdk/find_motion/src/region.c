@@ -0,0 +1,121 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : region.c                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The region manager: section-aligned allocation and the MMU attributes  */
+/*  of the declared regions.                                               */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "region.h"
+#include "arena.h"
+
+#ifndef HOST_BUILD
+#include "xil_mmu.h"
+#include "xil_cache.h"
+
+/* Bounds of the .regions area, defined in lscript.ld. */
+extern uint8 _region_start[], _region_end[];
+#endif
+
+typedef struct
+{
+    const char *name;
+    uint8      *addr;
+    uint32     size;
+    MemPolicy  policy;
+} Region;
+
+static const char *policy_names[] =
+{
+    "write-back", "write-combine", "non-cacheable", "shared"
+};
+
+static Arena  region_arena = { "regions", REGION_HOST_SIZE + SECTION_SIZE };
+static Region regions[MAX_REGIONS];
+static int    nregions;
+
+#ifndef HOST_BUILD
+static u32 section_attributes(MemPolicy policy)
+{
+    switch (policy)
+    {
+    case MEM_WRITE_COMBINE:
+    case MEM_NON_CACHEABLE:
+        return NORM_NONCACHE;       /* TEX=001, C=B=0 */
+    case MEM_SHARED:
+        return NORM_WB_CACHE;       /* as in translation_table.S */
+    default:
+        return NORM_WB_CACHE & NON_SHAREABLE;
+    }
+}
+#endif
+
+int region_declare(const char *name, void *addr, uint32 size,
+                   MemPolicy policy)
+/* Apply the policy to the sections from addr to addr+size, which must  */
+/* be section aligned. The cached data of the range is written back     */
+/* first. Returns 1 if the range is not aligned or the table is full.   */
+{
+    uint8 *p = addr;
+
+    if (((size_t) p | size) & (SECTION_SIZE-1))
+    {
+        printf("region_declare: '%s' is not aligned to 1MB sections.\n", name);
+        return 1;
+    }
+    if (nregions == MAX_REGIONS)
+    {
+        printf("region_declare: Too many regions for '%s'!\n", name);
+        return 1;
+    }
+#ifndef HOST_BUILD
+    Xil_DCacheFlushRange((INTPTR) p, size);
+    for (; p < (uint8 *) addr + size; p += SECTION_SIZE)
+    {
+        Xil_SetTlbAttributes((INTPTR) p, section_attributes(policy));
+    }
+#endif
+    regions[nregions].name = name;
+    regions[nregions].addr = addr;
+    regions[nregions].size = size;
+    regions[nregions].policy = policy;
+    nregions++;
+    return 0;
+}
+
+void *region_alloc(const char *name, uint32 size, MemPolicy policy)
+/* Allocate size bytes, rounded up to whole sections, from the .regions */
+/* area and give them the policy. Exits if the area is full.            */
+{
+    void *p;
+
+#ifndef HOST_BUILD
+    if (region_arena.base == NULL)
+    {
+        region_arena.base = _region_start;
+        region_arena.size = (uint32) (_region_end - _region_start);
+    }
+#endif
+    size = (size + SECTION_SIZE-1) & ~(SECTION_SIZE-1);
+    p = arena_alloc(&region_arena, name, size, SECTION_SIZE);
+    if (region_declare(name, p, size, policy))
+    {
+        exit(1);
+    }
+    return p;
+}
+
+void report_regions(void)
+/* Print the declared regions and their policies. */
+{
+    int i;
+
+    printf("Region              address      size  policy\n");
+    for (i = 0; i < nregions; i++)
+    {
+        printf("%-18s  0x%08lx  %5lu MB  %s\n", regions[i].name,
+               (unsigned long) (size_t) regions[i].addr,
+               (unsigned long) regions[i].size/SECTION_SIZE,
+               policy_names[regions[i].policy]);
+    }
+}
@@ -0,0 +1,56 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : region.h                                                      */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Memory attributes of the buffers of the application. The MMU of the    */
+/*  Cortex-A9 sets the cache policy per 1MB section, and translation_      */
+/*  table.S maps all of the DDR as shareable write-back/write-allocate.    */
+/*  A buffer that needs another policy is declared here instead:           */
+/*                                                                         */
+/*      MEM_WRITE_BACK    : write-back/write-allocate, not shared between  */
+/*                          the cores; frame buffers and scratch memory.  */
+/*      MEM_WRITE_COMBINE : normal non-cacheable; stores are merged in the */
+/*                          store buffer. For output streams that the CPU */
+/*                          only writes.                                   */
+/*      MEM_NON_CACHEABLE : normal non-cacheable, the same attributes as   */
+/*                          MEM_WRITE_COMBINE; buffers the CPU reads and  */
+/*                          the DMA writes without cache maintenance.     */
+/*                          Unaligned accesses work, unlike on device     */
+/*                          memory, so memcpy() is safe on pixels there.  */
+/*      MEM_SHARED        : the default mapping of the DDR, shareable      */
+/*                          write-back, kept coherent between the two     */
+/*                          cores by the SCU. Declaring it changes no     */
+/*                          attribute; it lists the buffer in             */
+/*                          report_regions() and undoes another policy.   */
+/*                                                                         */
+/*  region_alloc() takes whole sections from the .regions area of          */
+/*  lscript.ld, so a buffer never shares a section with other data. On    */
+/*  the host (HOST_BUILD) the policies are only recorded.                 */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __REGION_H__
+
+#include "image.h"
+
+#define SECTION_SIZE 0x100000
+
+/* Size of the .regions area on the host. */
+#define REGION_HOST_SIZE (32*1024*1024)
+
+#define MAX_REGIONS 16
+
+typedef enum
+{
+    MEM_WRITE_BACK,
+    MEM_WRITE_COMBINE,
+    MEM_NON_CACHEABLE,
+    MEM_SHARED
+} MemPolicy;
+
+void *region_alloc(const char *name, uint32 size, MemPolicy policy);
+int   region_declare(const char *name, void *addr, uint32 size,
+                     MemPolicy policy);
+void  report_regions(void);
+
+#define __REGION_H__
+#endif
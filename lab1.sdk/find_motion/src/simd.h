@@ -0,0 +1,106 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : simd.h                                                        */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  A thin wrapper over the SIMD instruction sets we care about. The image */
+/*  kernels are written once against the vu8 type below, which holds      */
+/*  VLEN unsigned 8-bit pixels:                                            */
+/*                                                                         */
+/*      NEON (Cortex-A9, -mfpu=neon) : 16 pixels per vector                */
+/*      AVX2 (host)                  : 32 pixels per vector                */
+/*      SSE2 (host)                  : 16 pixels per vector                */
+/*      none                         :  1 pixel, plain C                   */
+/*                                                                         */
+/*  For the linear filters a vu8 can be widened into two vu16 vectors of   */
+/*  VLEN/2 unsigned 16-bit lanes each (vu16_lo, vu16_hi) and packed back   */
+/*  with unsigned saturation (vu16_pack). On AVX2 the widening works per   */
+/*  128-bit lane, so the lo/hi halves are not contiguous pixel ranges;     */
+/*  this is harmless as long as the same pixels are always packed back     */
+/*  together. The 16-bit operations are only defined when VLEN > 1.        */
+/*                                                                         */
+/*  All loads and stores are unaligned.                                    */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __SIMD_H__
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+#include <arm_neon.h>
+#define VLEN 16
+typedef uint8x16_t vu8;
+#define vu8_load(p)      vld1q_u8(p)
+#define vu8_store(p, v)  vst1q_u8(p, v)
+#define vu8_min(a, b)    vminq_u8(a, b)
+#define vu8_max(a, b)    vmaxq_u8(a, b)
+
+typedef uint16x8_t vu16;
+#define vu16_load(p)      vld1q_u16(p)
+#define vu16_store(p, v)  vst1q_u16(p, v)
+#define vu16_lo(v)        vmovl_u8(vget_low_u8(v))
+#define vu16_hi(v)        vmovl_u8(vget_high_u8(v))
+#define vu16_pack(lo, hi) vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi))
+#define vu16_set(c)       vdupq_n_u16(c)
+#define vu16_add(a, b)    vaddq_u16(a, b)
+#define vu16_shl(a, n)    vshlq_n_u16(a, n)
+#define vu16_shr(a, n)    vshrq_n_u16(a, n)
+#define vu16_mulhi(a, c)  vcombine_u16( \
+            vshrn_n_u32(vmull_n_u16(vget_low_u16(a), c), 16), \
+            vshrn_n_u32(vmull_n_u16(vget_high_u16(a), c), 16))
+
+#elif defined(__AVX2__)
+
+#include <immintrin.h>
+#define VLEN 32
+typedef __m256i vu8;
+#define vu8_load(p)      _mm256_loadu_si256((const __m256i *) (p))
+#define vu8_store(p, v)  _mm256_storeu_si256((__m256i *) (p), v)
+#define vu8_min(a, b)    _mm256_min_epu8(a, b)
+#define vu8_max(a, b)    _mm256_max_epu8(a, b)
+
+typedef __m256i vu16;
+#define vu16_load(p)      _mm256_loadu_si256((const __m256i *) (p))
+#define vu16_store(p, v)  _mm256_storeu_si256((__m256i *) (p), v)
+#define vu16_lo(v)        _mm256_unpacklo_epi8(v, _mm256_setzero_si256())
+#define vu16_hi(v)        _mm256_unpackhi_epi8(v, _mm256_setzero_si256())
+#define vu16_pack(lo, hi) _mm256_packus_epi16(lo, hi)
+#define vu16_set(c)       _mm256_set1_epi16((short) (c))
+#define vu16_add(a, b)    _mm256_add_epi16(a, b)
+#define vu16_shl(a, n)    _mm256_slli_epi16(a, n)
+#define vu16_shr(a, n)    _mm256_srli_epi16(a, n)
+#define vu16_mulhi(a, c)  _mm256_mulhi_epu16(a, vu16_set(c))
+
+#elif defined(__SSE2__)
+
+#include <emmintrin.h>
+#define VLEN 16
+typedef __m128i vu8;
+#define vu8_load(p)      _mm_loadu_si128((const __m128i *) (p))
+#define vu8_store(p, v)  _mm_storeu_si128((__m128i *) (p), v)
+#define vu8_min(a, b)    _mm_min_epu8(a, b)
+#define vu8_max(a, b)    _mm_max_epu8(a, b)
+
+typedef __m128i vu16;
+#define vu16_load(p)      _mm_loadu_si128((const __m128i *) (p))
+#define vu16_store(p, v)  _mm_storeu_si128((__m128i *) (p), v)
+#define vu16_lo(v)        _mm_unpacklo_epi8(v, _mm_setzero_si128())
+#define vu16_hi(v)        _mm_unpackhi_epi8(v, _mm_setzero_si128())
+#define vu16_pack(lo, hi) _mm_packus_epi16(lo, hi)
+#define vu16_set(c)       _mm_set1_epi16((short) (c))
+#define vu16_add(a, b)    _mm_add_epi16(a, b)
+#define vu16_shl(a, n)    _mm_slli_epi16(a, n)
+#define vu16_shr(a, n)    _mm_srli_epi16(a, n)
+#define vu16_mulhi(a, c)  _mm_mulhi_epu16(a, vu16_set(c))
+
+#else
+
+#define VLEN 1
+typedef unsigned char vu8;
+#define vu8_load(p)      (*(p))
+#define vu8_store(p, v)  (*(p) = (v))
+#define vu8_min(a, b)    ((a) < (b)? (a) : (b))
+#define vu8_max(a, b)    ((a) > (b)? (a) : (b))
+
+#endif
+
+#define __SIMD_H__
+#endif
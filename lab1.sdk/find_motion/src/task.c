@@ -0,0 +1,194 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : task.c                                                        */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  The cooperative scheduler of task.h.                                   */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "task.h"
+#include "amp.h"
+
+#ifdef HOST_BUILD
+#include <ucontext.h>
+#endif
+
+struct Task
+{
+    const char *name;
+    TaskFunc   func;
+    void       *arg;
+#ifdef HOST_BUILD
+    ucontext_t context;
+#else
+    uint32     *sp;        /* saved stack pointer while switched out     */
+#endif
+    uint8      *stack;
+    int        done;
+    long       usec;       /* time run                                   */
+    int32      switches;   /* times switched in                          */
+};
+
+/* Defined in find_motion.c. */
+long get_usec_time();
+
+static Task  tasks[MAX_TASKS];
+static int   ntasks, current;
+static int   core;         /* the core running the tasks                 */
+static long  switched;     /* time of the last switch                    */
+
+#ifndef HOST_BUILD
+/* Save the callee-saved registers of the AAPCS, the VFP ones included, */
+/* on the current stack, store the stack pointer in *save and resume    */
+/* the task whose stack pointer is sp.                                  */
+void task_switch(uint32 **save, uint32 *sp);
+
+__asm__(
+"   .text\n"
+"   .arm\n"
+"   .global task_switch\n"
+"   .type   task_switch, %function\n"
+"task_switch:\n"
+"   push    {r4-r11, lr}\n"
+"   vpush   {d8-d15}\n"
+"   str     sp, [r0]\n"
+"   mov     sp, r1\n"
+"   vpop    {d8-d15}\n"
+"   pop     {r4-r11, pc}\n"
+);
+
+void XSdPs_PollHook(void)
+/* Let the other tasks run while the SD card transfers data. */
+{
+    task_yield();
+}
+#endif
+
+static void task_start(void)
+/* First code run by a new task. */
+{
+    Task *task = &tasks[current];
+
+    task->func(task->arg);
+    task_end();
+}
+
+Task *task_create(const char *name, TaskFunc func, void *arg)
+/* Create a task that runs func(arg) on its own stack once the current */
+/* task yields. The slot of an ended task is reused. Returns NULL if   */
+/* MAX_TASKS tasks are running.                                        */
+{
+    Task *task;
+    int  i;
+
+    if (ntasks == 0)
+    {
+        tasks[0].name = "main";
+        ntasks = 1;
+        core = amp_cpu_id();
+        switched = get_usec_time();
+    }
+    for (i = 1; i < ntasks && !tasks[i].done; i++)
+        ;
+    if (i == MAX_TASKS)
+    {
+        return NULL;
+    }
+    if (i == ntasks)
+    {
+        ntasks++;
+    }
+    task = &tasks[i];
+    memset(task, 0, sizeof(Task));
+    task->name = name;
+    task->func = func, task->arg = arg;
+    task->stack = get_memory("task stack", TASK_STACK_SIZE);
+#ifdef HOST_BUILD
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = TASK_STACK_SIZE;
+    task->context.uc_link = NULL;
+    makecontext(&task->context, task_start, 0);
+#else
+    /* The first switch pops zeroed registers and returns to task_start. */
+    task->sp = (uint32 *) (task->stack + TASK_STACK_SIZE) - (16 + 9);
+    memset(task->sp, 0, (16 + 9)*sizeof(uint32));
+    task->sp[16 + 8] = (uint32) task_start;
+#endif
+    return task;
+}
+
+static void switch_to(int next)
+{
+    Task *from = &tasks[current];
+    long now = get_usec_time();
+
+    from->usec += now - switched;
+    switched = now;
+    current = next;
+    tasks[next].switches++;
+#ifdef HOST_BUILD
+    swapcontext(&from->context, &tasks[next].context);
+#else
+    task_switch(&from->sp, tasks[next].sp);
+#endif
+}
+
+int task_yield(void)
+/* Switch to the next task that has not ended. Returns 0 at once if     */
+/* there is none, or on the other core, which runs no tasks but may    */
+/* call the SD driver and FatFs too; 1 once the task is resumed.       */
+{
+    int next;
+
+    if (ntasks < 2 || amp_cpu_id() != core)
+    {
+        return 0;
+    }
+
+    for (next = (current + 1) % ntasks; next != current;
+         next = (next + 1) % ntasks)
+    {
+        if (!tasks[next].done)
+        {
+            switch_to(next);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void task_end(void)
+/* End the current task, which is never resumed. The main task cannot */
+/* end; the call returns in it.                                        */
+{
+    if (current == 0)
+    {
+        return;
+    }
+    tasks[current].done = 1;
+    task_yield();
+}
+
+int task_done(Task *task)
+{
+    return task->done;
+}
+
+long task_usec(Task *task)
+/* Time the task has run, in microseconds. */
+{
+    return task->usec + ((task == &tasks[current])?
+                         get_usec_time() - switched : 0);
+}
+
+void report_tasks(void)
+{
+    int i;
+
+    printf("\n%-12s %9s %9s\n", "task", "ms", "switches");
+    for (i = 0; i < ntasks; i++)
+    {
+        printf("%-12s %9.1f %9ld\n", tasks[i].name,
+               task_usec(&tasks[i])/1000.0, (long) tasks[i].switches);
+    }
+}
@@ -0,0 +1,40 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : task.h                                                        */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Cooperative tasks (stackful coroutines) on one core. Each task runs   */
+/*  on a stack of its own until it calls task_yield(), which switches to  */
+/*  the next task in round-robin order; there is no preemption, so the    */
+/*  tasks share the arenas without locks. FatFs is guarded by the volume  */
+/*  locks of fslock.h, which yield while another task holds them. The    */
+/*  caller of the first task_create() becomes the main task.              */
+/*                                                                         */
+/*  The SD driver yields while it waits for the end of a DMA transfer     */
+/*  (XSdPs_PollHook()), so a task reading a file lets the other tasks     */
+/*  compute during the transfer. A yield with no other task, or on the    */
+/*  core that did not create the tasks, returns at once. On the host      */
+/*  (HOST_BUILD) the tasks are ucontext coroutines.                        */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __TASK_H__
+
+#include "image.h"
+
+#define MAX_TASKS 4
+
+/* Stack size of a task, in bytes. */
+#define TASK_STACK_SIZE (16*1024)
+
+typedef void (*TaskFunc)(void *arg);
+
+typedef struct Task Task;
+
+Task *task_create(const char *name, TaskFunc func, void *arg);
+int   task_yield(void);
+int   task_done(Task *task);
+long  task_usec(Task *task);
+void  task_end(void);
+void  report_tasks(void);
+
+#define __TASK_H__
+#endif
@@ -0,0 +1,175 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : telemetry.c                                                   */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Allocation tags, heap high-water mark and per-stage traffic.           */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#include "telemetry.h"
+
+static MemTag     tags[MAX_MEM_TAGS];
+static int        ntags;
+static StageStats stages[MAX_STAGES];
+static int        nstages;
+
+#ifndef HOST_BUILD
+#include <sys/types.h>
+
+/* Bounds of the heap, defined in lscript.ld. */
+extern uint8 _heap_start[], _heap_end[];
+
+static uint8 *heap_top;
+static uint32 heap_peak;
+
+caddr_t _sbrk(int incr)
+/* Same as the _sbrk() of the standalone BSP, which newlib calls to grow */
+/* the heap, but keeps the high-water mark of the heap.                  */
+{
+    uint8 *prev;
+
+    if (heap_top == NULL)
+    {
+        heap_top = _heap_start;
+    }
+    if (heap_top + incr > _heap_end)
+    {
+        return (caddr_t) -1;
+    }
+    prev = heap_top;
+    heap_top += incr;
+    if ((uint32) (heap_top - _heap_start) > heap_peak)
+    {
+        heap_peak = (uint32) (heap_top - _heap_start);
+    }
+    return (caddr_t) prev;
+}
+
+uint32 heap_high_water(void)
+{
+    return heap_peak;
+}
+#else
+uint32 heap_high_water(void)
+{
+    return 0;
+}
+#endif
+
+int mem_tag(const char *name)
+/* Return the index of the tag of the name, adding it if it is new. The */
+/* allocations beyond MAX_MEM_TAGS names share the last tag.            */
+{
+    int i;
+
+    for (i = 0; i < ntags; i++)
+    {
+        if (tags[i].name == name || !strcmp(tags[i].name, name))
+        {
+            return i;
+        }
+    }
+    if (ntags == MAX_MEM_TAGS)
+    {
+        tags[MAX_MEM_TAGS-1].name = "(other)";
+        return MAX_MEM_TAGS-1;
+    }
+    tags[ntags].name = name;
+    return ntags++;
+}
+
+void tag_alloc(int tag, uint32 size)
+{
+    tags[tag].live += size;
+    tags[tag].total += size;
+    tags[tag].count++;
+    if (tags[tag].live > tags[tag].peak)
+    {
+        tags[tag].peak = tags[tag].live;
+    }
+}
+
+void tag_free(int tag, uint32 size)
+{
+    tags[tag].live -= (size < tags[tag].live)? size : tags[tag].live;
+}
+
+void record_stage(const char *name, double bytes, long usec)
+/* Add the traffic and the time of one run of the stage. */
+{
+    int i;
+
+    for (i = 0; i < nstages && strcmp(stages[i].name, name); i++)
+        ;
+    if (i == nstages)
+    {
+        if (nstages == MAX_STAGES)
+        {
+            return;
+        }
+        stages[nstages].name = name;
+        nstages++;
+    }
+    stages[i].bytes += bytes;
+    stages[i].usec += usec;
+    stages[i].runs++;
+}
+
+int get_mem_tags(const MemTag **list)
+{
+    *list = tags;
+    return ntags;
+}
+
+int get_stages(const StageStats **list)
+{
+    *list = stages;
+    return nstages;
+}
+
+void clear_telemetry(void)
+/* Forget the stages and the peaks of the tags; the live bytes are kept. */
+{
+    int i;
+
+    for (i = 0; i < ntags; i++)
+    {
+        tags[i].peak = tags[i].live;
+        tags[i].total = 0;
+        tags[i].count = 0;
+    }
+    memset(stages, 0, sizeof(stages));
+    nstages = 0;
+}
+
+void report_telemetry(void)
+/* Print the tags, the heap high-water mark and the stage traffic. */
+{
+    int i;
+
+    printf("\n%-16s %9s %9s %9s %6s\n", "memory tag", "live KB", "peak KB",
+           "total KB", "allocs");
+    for (i = 0; i < ntags; i++)
+    {
+        printf("%-16s %9lu %9lu %9lu %6ld\n", tags[i].name,
+               (unsigned long) (tags[i].live + 1023)/1024,
+               (unsigned long) (tags[i].peak + 1023)/1024,
+               (unsigned long) (tags[i].total + 1023)/1024,
+               (long) tags[i].count);
+    }
+    if (heap_high_water())
+    {
+        printf("Heap high-water mark: %lu KB.\n",
+               (unsigned long) (heap_high_water() + 1023)/1024);
+    }
+    if (nstages == 0)
+    {
+        return;
+    }
+    printf("\n%-16s %9s %9s %9s\n", "stage", "moved KB", "ms", "MB/s");
+    for (i = 0; i < nstages; i++)
+    {
+        printf("%-16s %9.0f %9.1f %9.1f\n", stages[i].name,
+               stages[i].bytes/1024, stages[i].usec/1000.0,
+               stages[i].usec? stages[i].bytes/stages[i].usec : 0.0);
+    }
+}
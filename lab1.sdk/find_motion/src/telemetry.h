@@ -0,0 +1,58 @@
+/* /////////////////////////////////////////////////////////////////////// */
+/*  File   : telemetry.h                                                   */
+/*  Date   : 10/16/2026                                                    */
+/* ----------------------------------------------------------------------- */
+/*  Memory telemetry of a run:                                             */
+/*                                                                         */
+/*      tags   : the bytes held per allocation name, the name given to    */
+/*               get_memory(), ocm_alloc() or pool_get(). The arenas      */
+/*               report every allocation and release here.                */
+/*      heap   : the high-water mark of the newlib heap, recorded by the  */
+/*               _sbrk() of telemetry.c, which replaces the weak one of   */
+/*               the standalone BSP. It is not tracked on the host.       */
+/*      stages : the bytes moved to and from memory by each stage of the  */
+/*               pipeline and the time it took, as estimated by the       */
+/*               caller of record_stage().                                */
+/*                                                                         */
+/*  report_telemetry() prints all three as a table. The host build reads  */
+/*  the same figures through get_mem_tags() and get_stages().              */
+/* /////////////////////////////////////////////////////////////////////// */
+
+#ifndef __TELEMETRY_H__
+
+#include "image.h"
+
+#define MAX_MEM_TAGS 32
+#define MAX_STAGES   16
+
+typedef struct
+{
+    const char *name;
+    uint32 live;      /* bytes currently held                            */
+    uint32 peak;      /* high-water mark of live                         */
+    uint32 total;     /* bytes allocated over the run                    */
+    int32  count;     /* number of allocations                           */
+} MemTag;
+
+typedef struct
+{
+    const char *name;
+    double bytes;     /* estimated bytes read and written                */
+    long   usec;
+    int32  runs;
+} StageStats;
+
+int    mem_tag(const char *name);
+void   tag_alloc(int tag, uint32 size);
+void   tag_free(int tag, uint32 size);
+uint32 heap_high_water(void);
+
+void   record_stage(const char *name, double bytes, long usec);
+
+int    get_mem_tags(const MemTag **tags);
+int    get_stages(const StageStats **stages);
+void   clear_telemetry(void);
+void   report_telemetry(void);
+
+#define __TELEMETRY_H__
+#endif
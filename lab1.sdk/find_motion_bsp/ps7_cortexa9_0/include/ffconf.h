@@ -198,6 +198,16 @@ extern "C" {
 /  GET_SECTOR_SIZE command must be implemented to the disk_ioctl() function. */
 
 
+#define	_MAX_XFER	4096U
+/* Largest number of sectors f_read() passes to one disk_read(). When a read spans
+/  clusters that follow one another on the disk, they are read in one transfer of up
+/  to _MAX_XFER sectors instead of one per cluster. 0 keeps one transfer per cluster.
+/
+/  4096 sectors (2MB) is the limit of the SD driver (sdps): its ADMA2 table has 32
+/  descriptors of 64KB each and is not bounds-checked.
+*/
+
+
 #define	_USE_ERASE	0	/* 0:Disable or 1:Enable */
 /* To enable sector erase feature, set _USE_ERASE to 1. Also CTRL_ERASE_SECTOR command
 /  should be added to the disk_ioctl() function. */
@@ -226,15 +236,20 @@ extern "C" {
 /  with file lock control. This feature uses bss _FS_LOCK * 12 bytes. */
 
 
-#define _FS_REENTRANT	0		/* 0:Disable or 1:Enable */
+#define _FS_REENTRANT	1		/* 0:Disable or 1:Enable */
 #define _FS_TIMEOUT		1000	/* Timeout period in unit of time tick */
-#define	_SYNC_t			HANDLE	/* O/S dependent sync object type. e.g. HANDLE, OS_EVENT*, ID, SemaphoreHandle_t and etc.. */
+struct FsLock;
+#define	_SYNC_t			struct FsLock *	/* O/S dependent sync object type. e.g. HANDLE, OS_EVENT*, ID, SemaphoreHandle_t and etc.. */
 /* The _FS_REENTRANT option switches the re-entrancy (thread safe) of the FatFs module.
 /
 /   0: Disable re-entrancy. _FS_TIMEOUT and _SYNC_t have no effect.
 /   1: Enable re-entrancy. Also user provided synchronization handlers,
 /      ff_req_grant(), ff_rel_grant(), ff_del_syncobj() and ff_cre_syncobj()
 /      function must be added to the project.
+/
+/  Enabled for the application: both A9 cores and the tasks of CPU0 open
+/  files on the SD card, serialized by the spinlocks of find_motion/src/fslock.c.
+/  The time tick of _FS_TIMEOUT is one millisecond there.
 */
 
 
@@ -74,6 +74,10 @@
 *       sk     10/13/16 Reduced the delay during power cycle to 1ms as per spec
 *       sk     10/19/16 Used emmc_hwreset pin to reset eMMC.
 *       sk     11/07/16 Enable Rst_n bit in ext_csd reg if not enabled.
+*              10/16/26 Call XSdPs_PollHook() while polling for the end of
+*                       a data transfer.
+*              10/16/26 Invalidate the read buffer again at the end of the
+*                       transfer, after the lines the hook may have loaded.
 * </pre>
 *
 ******************************************************************************/
@@ -1130,6 +1134,19 @@ u32 XSdPs_FrameCmd(XSdPs *InstancePtr, u32 Cmd)
 		return RetVal;
 }
 
+/*****************************************************************************/
+/**
+* Called repeatedly while a read or a write waits for the end of its DMA
+* transfer. The application can override this weak default to run other
+* work, e.g. switch to another task, during the transfer.
+*
+* @return	None
+*
+******************************************************************************/
+__attribute__((weak)) void XSdPs_PollHook(void)
+{
+}
+
 /*****************************************************************************/
 /**
 * This function performs SD read in polled mode.
@@ -1206,6 +1223,9 @@ s32 XSdPs_ReadPolled(XSdPs *InstancePtr, u32 Arg, u32 BlkCnt, u8 *Buff)
 			Status = XST_FAILURE;
 			goto RETURN_PATH;
 		}
+		if ((StatusReg & XSDPS_INTR_TC_MASK) == 0U) {
+			XSdPs_PollHook();
+		}
 	} while((StatusReg & XSDPS_INTR_TC_MASK) == 0U);
 
 	/* Write to clear bit */
@@ -1214,6 +1234,13 @@ s32 XSdPs_ReadPolled(XSdPs *InstancePtr, u32 Arg, u32 BlkCnt, u8 *Buff)
 	Status = (s32)XSdPs_ReadReg(InstancePtr->Config.BaseAddress,
 			XSDPS_RESP0_OFFSET);
 
+	/*
+	 * Code run by XSdPs_PollHook() during the transfer may have loaded
+	 * lines of the buffer into the cache before the DMA wrote them:
+	 * drop them so the data of the card is read.
+	 */
+	Xil_DCacheInvalidateRange((INTPTR)Buff, BlkCnt * XSDPS_BLK_SIZE_512_MASK);
+
 	Status = XST_SUCCESS;
 
 RETURN_PATH:
@@ -1299,6 +1326,9 @@ s32 XSdPs_WritePolled(XSdPs *InstancePtr, u32 Arg, u32 BlkCnt, const u8 *Buff)
 			Status = XST_FAILURE;
 			goto RETURN_PATH;
 		}
+		if ((StatusReg & XSDPS_INTR_TC_MASK) == 0U) {
+			XSdPs_PollHook();
+		}
 	} while((StatusReg & XSDPS_INTR_TC_MASK) == 0U);
 
 	/* Write to clear bit */
@@ -231,6 +231,7 @@ s32 XSdPs_CfgInitialize(XSdPs *InstancePtr, XSdPs_Config *ConfigPtr,
 s32 XSdPs_SdCardInitialize(XSdPs *InstancePtr);
 s32 XSdPs_ReadPolled(XSdPs *InstancePtr, u32 Arg, u32 BlkCnt, u8 *Buff);
 s32 XSdPs_WritePolled(XSdPs *InstancePtr, u32 Arg, u32 BlkCnt, const u8 *Buff);
+void XSdPs_PollHook(void);
 s32 XSdPs_SetBlkSize(XSdPs *InstancePtr, u16 BlkSize);
 s32 XSdPs_Select_Card (XSdPs *InstancePtr);
 s32 XSdPs_Change_ClkFreq(XSdPs *InstancePtr, u32 SelFreq);
@@ -346,7 +346,7 @@ DRESULT disk_read (
 		BYTE pdrv,	/* Physical drive number (0) */
 		BYTE *buff,	/* Pointer to the data buffer to store read data */
 		DWORD sector,	/* Start sector number (LBA) */
-		UINT count	/* Sector count (1..128) */
+		UINT count	/* Sector count (1.._MAX_XFER) */
 )
 {
 #ifdef FILE_SYSTEM_INTERFACE_SD
@@ -2886,7 +2886,7 @@ FRESULT f_read (
 {
 	FRESULT res;
 	DWORD clst, sect, remain;
-	UINT rcnt, cc;
+	UINT rcnt, cc, want, ncc;
 	BYTE csect, *rbuff = (BYTE*)(void *)buff;
 
 
@@ -2938,9 +2938,36 @@ FRESULT f_read (
 			cc = btr / SS(fp->fs);				/* When remaining bytes >= sector size, */
 			if (cc != 0U) {							/* Read maximum contiguous sectors directly */
 				if ((csect + cc) > fp->fs->csize) {	/* Clip at cluster boundary */
+					want = cc;
 					cc = (UINT)(fp->fs->csize - csect);
+#if _MAX_XFER
+					while (cc < want) {				/* Extend over the clusters that follow on the disk */
+						ncc = want - cc;
+						if (ncc > (UINT)fp->fs->csize) {
+							ncc = (UINT)fp->fs->csize;
+						}
+						if ((cc + ncc) > _MAX_XFER) {
+							break;
+						}
+#if _USE_FASTSEEK
+						if (fp->cltbl) {
+							clst = clmt_clust(fp, fp->fptr + (DWORD)cc * SS(fp->fs));
+						}
+						else
+#endif
+							clst = get_fat(fp->fs, fp->clust);
+						if (clst == 0xFFFFFFFFU) {
+							ABORT(fp->fs, FR_DISK_ERR);
+						}
+						if (clst != (fp->clust + 1U)) {	/* Fragmented: the next cluster is read on its own */
+							break;
+						}
+						fp->clust = clst;			/* The last cluster read */
+						cc += ncc;
+					}
+#endif
 				}
-				if (disk_read(fp->fs->drv, rbuff, sect, (BYTE)cc) != RES_OK) {
+				if (disk_read(fp->fs->drv, rbuff, sect, cc) != RES_OK) {
 					ABORT(fp->fs, FR_DISK_ERR);
 				}
 #if !_FS_READONLY && _FS_MINIMIZE <= 2			/* Replace one of the read sectors with cached data if it contains a dirty sector */